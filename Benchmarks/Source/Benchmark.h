@@ -0,0 +1,92 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <iostream>
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * BENCHMARK
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Strumenti comuni ai benchmark di SubSaverBenchmarks:
+ * - measureNsPerSample: tempo per sample di una funzione che elabora un
+ *   blocco. Warm-up, poi il minimo su più ripetizioni (il minimo è la stima
+ *   meno disturbata da scheduler e frequenza della CPU). Denormali
+ *   disattivati come in processBlock.
+ * - fillSignal: segnale di prova deterministico (due sinusoidi più rumore)
+ * - stampa a colonne dei risultati
+ *
+ * I valori dipendono da CPU, compilatore e flag: vanno confrontati solo
+ * tra righe della stessa esecuzione (build Release).
+ */
+namespace Benchmark
+{
+    /**
+     * @param numSamplesPerCall sample elaborati da una chiamata di function
+     * @param function          elabora un blocco (chiamata numCallsPerRun volte per ripetizione)
+     * @return ns per sample, minimo sulle ripetizioni
+     */
+    template <typename Function>
+    double measureNsPerSample(int numSamplesPerCall, Function&& function, int numCallsPerRun = 64, int numRuns = 15)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        for (int i = 0; i < numCallsPerRun; ++i)
+            function();
+
+        double best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numCallsPerRun; ++i)
+                function();
+
+            const auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            best = juce::jmin(best, elapsed * 1.0e9 / (static_cast<double>(numSamplesPerCall) * numCallsPerRun));
+        }
+
+        return best;
+    }
+
+    // Due sinusoidi non armoniche più rumore, ampiezza di picco ~amplitude
+    inline void fillSignal(float* destination, int numSamples, float amplitude, int seed = 1)
+    {
+        juce::Random random(seed);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float t = static_cast<float>(i);
+            destination[i] = amplitude * (0.6f * std::sin(0.0131f * t)
+                                        + 0.3f * std::sin(0.171f * t + 0.5f)
+                                        + 0.1f * (2.0f * random.nextFloat() - 1.0f));
+        }
+    }
+
+    inline void fillSignal(juce::AudioBuffer<float>& buffer, float amplitude)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            fillSignal(buffer.getWritePointer(ch), buffer.getNumSamples(), amplitude, ch + 1);
+    }
+
+    inline void printHeader(const juce::String& title, const juce::String& columns)
+    {
+        std::cout << "\n" << title << "\n" << columns << "\n";
+    }
+
+    inline void printRow(const juce::String& label, std::initializer_list<double> values, int decimals = 2)
+    {
+        juce::String line = label.paddedRight(' ', 32);
+
+        for (const double value : values)
+            line += juce::String(value, decimals).paddedLeft(' ', 10);
+
+        std::cout << line << "\n";
+    }
+
+    inline void printNote(const juce::String& text)
+    {
+        std::cout << "  " << text << "\n";
+    }
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "../../Source/PluginProcessor.h"
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * CHAIN CHECKS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Verifiche sull'intero SubSaverAudioProcessor (non benchmark):
+ * - Latenza: la latenza riportata all'host coincide con il ritardo misurato
+ *   del wet e del dry, per ogni sample rate, configurazione di oversampling,
+ *   ordine ADAA e modalità del disperser, con il tilt attivo
+ *
+ * Il drive segue l'envelope dell'ingresso, quindi la catena non ha una
+ * risposta all'impulso: la sonda è una sinusoide stazionaria a
+ * PROBE_FREQUENCY e il ritardo è quello di fase della fondamentale (lo
+ * shaper è senza memoria e dispari, l'ADAA è un kernel simmetrico). Dal
+ * ritardo misurato si tolgono le fasi note a latenza zero: DC blocker
+ * (analitica) e cascata del disperser (un Disperser a parte con gli stessi
+ * parametri). Pre e post tilt hanno gain opposti e si compensano.
+ * La fase risolve errori entro mezzo periodo della sonda (±5.5 sample a
+ * 44.1kHz, ±24 a 192kHz).
+ */
+struct ChainChecks
+{
+    static constexpr int BLOCK_SIZE = 512;
+    static constexpr int NUM_CHANNELS = 2;
+    static constexpr double PROBE_FREQUENCY = 4000.0;  // Periodi interi in SETTLE_SECONDS e MEASURE_SECONDS
+    static constexpr float PROBE_AMPLITUDE = 0.1f;
+    static constexpr double SETTLE_SECONDS = 0.5;      // Envelope, DC blocker e disperser a regime
+    static constexpr double MEASURE_SECONDS = 0.5;
+    static constexpr double LATENCY_TOLERANCE = 0.05;  // Sample alla frequenza nativa
+    static constexpr float TILT = 6.0f;
+    static constexpr float DISPERSER_AMOUNT = 0.5f;
+    static constexpr juce::uint32 DESIGN_WAIT_MS = 300;       // Oltre il design e MIN_DESIGN_INTERVAL_MS
+
+    static constexpr double SAMPLE_RATES[] = { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+
+    // Fattore (indice 0-4) e filtro; a 1x il filtro è irrilevante
+    struct OversamplingCase
+    {
+        const char* name;
+        int factorIndex;
+        int filterType;
+    };
+
+    static constexpr OversamplingCase OVERSAMPLING_CASES[] = {
+        { "1x", 0, 0 },
+        { "2x IIR", 1, 0 }, { "2x FIR", 1, 1 },
+        { "4x IIR", 2, 0 }, { "4x FIR", 2, 1 },
+        { "8x IIR", 3, 0 }, { "8x FIR", 3, 1 },
+        { "16x IIR", 4, 0 }, { "16x FIR", 4, 1 }
+    };
+
+    // Cascade con dispersione; Convolution con amount 0 (IR unitaria: solo la sua latenza)
+    struct DisperserCase
+    {
+        const char* name;
+        int mode;
+        float amount;
+    };
+
+    static constexpr DisperserCase DISPERSER_CASES[] = {
+        { "cascade", 0, DISPERSER_AMOUNT },
+        { "convolution", 1, 0.0f }
+    };
+
+    static void setParameter(SubSaverAudioProcessor& processor, const juce::String& name, float value)
+    {
+        auto* parameter = processor.parameters.getParameter(name);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    /**
+     * Elabora la sonda a blocchi con process(buffer) e restituisce il ritardo
+     * di fase (radianti) della fondamentale sul canale 0 rispetto all'ingresso,
+     * misurato dopo SETTLE_SECONDS
+     */
+    template <typename Process>
+    static double measureProbeLag(double sampleRate, Process&& process)
+    {
+        const double omega = juce::MathConstants<double>::twoPi * PROBE_FREQUENCY / sampleRate;
+        const auto settleSamples = static_cast<juce::int64>(std::llround(SETTLE_SECONDS * sampleRate));
+        const auto totalSamples = settleSamples + static_cast<juce::int64>(std::llround(MEASURE_SECONDS * sampleRate));
+
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, BLOCK_SIZE);
+        double cosSum = 0.0, sinSum = 0.0;
+
+        for (juce::int64 start = 0; start < totalSamples; start += BLOCK_SIZE)
+        {
+            const int numSamples = static_cast<int>(juce::jmin<juce::int64>(BLOCK_SIZE, totalSamples - start));
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), NUM_CHANNELS, numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto x = PROBE_AMPLITUDE * static_cast<float>(std::sin(omega * static_cast<double>(start + i)));
+                for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                    block.setSample(ch, i, x);
+            }
+
+            process(block);
+
+            // y = A cos(ωn - θ): le due correlazioni danno cos θ e sin θ
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto n = start + i;
+                if (n < settleSamples)
+                    continue;
+
+                const double phase = omega * static_cast<double>(n);
+                cosSum += block.getSample(0, i) * std::cos(phase);
+                sinSum += block.getSample(0, i) * std::sin(phase);
+            }
+        }
+
+        // L'ingresso A sin(ωn) = A cos(ωn - π/2) è già in ritardo di π/2
+        return std::atan2(sinSum, cosSum) - juce::MathConstants<double>::halfPi;
+    }
+
+    // Fase a latenza zero del disperser: cascata a parte, stessi parametri
+    static double measureDisperserLag(double sampleRate, const DisperserCase& disperserCase)
+    {
+        Disperser disperser(disperserCase.amount, Parameters::defaultDisperserFreq, Parameters::defaultDisperserPinch);
+        disperser.setNumStages(Parameters::defaultDisperserStages);
+        disperser.prepareToPlay(sampleRate, BLOCK_SIZE, NUM_CHANNELS);
+
+        juce::AudioBuffer<float> envelope(1, BLOCK_SIZE);
+        envelope.clear();
+
+        return measureProbeLag(sampleRate, [&](juce::AudioBuffer<float>& block)
+        {
+            disperser.processBlock(block, envelope);
+        });
+    }
+
+    // Elabora silenzio per DESIGN_WAIT_MS e per il riscaldamento dei motori
+    // (latenza più IR massima): la IR del designer è caricata e in uso
+    static void waitForDesign(SubSaverAudioProcessor& processor, juce::MidiBuffer& midi)
+    {
+        const auto end = juce::Time::getMillisecondCounter() + DESIGN_WAIT_MS;
+        int warmupBlocks = (Disperser::CONVOLUTION_LATENCY + Disperser::MAX_IR_LENGTH) / BLOCK_SIZE + 1;
+
+        juce::AudioBuffer<float> silence(NUM_CHANNELS, BLOCK_SIZE);
+        while (juce::Time::getMillisecondCounter() < end || warmupBlocks-- > 0)
+        {
+            silence.clear();
+            processor.processBlock(silence, midi);
+            juce::Thread::sleep(1);
+        }
+    }
+
+    /**
+     * Errore (sample) tra il ritardo misurato del wet o del dry e la latenza
+     * riportata, riportato in (-P/2, P/2] con P il periodo della sonda
+     */
+    static double measureLatencyError(double sampleRate, const OversamplingCase& oversamplingCase, int adaaOrder,
+                                      const DisperserCase& disperserCase, double disperserLag, bool wet)
+    {
+        SubSaverAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, BLOCK_SIZE);
+
+        setParameter(processor, Parameters::nameOversampling, 1.0f);
+        setParameter(processor, Parameters::nameOversamplingFactor, static_cast<float>(oversamplingCase.factorIndex));
+        setParameter(processor, Parameters::nameOversamplingFilter, static_cast<float>(oversamplingCase.filterType));
+        setParameter(processor, Parameters::nameAntiAliasing, static_cast<float>(adaaOrder));
+        setParameter(processor, Parameters::nameTilt, TILT);
+        setParameter(processor, Parameters::nameDisperserMode, static_cast<float>(disperserCase.mode));
+        setParameter(processor, Parameters::nameDisperserAmount, disperserCase.amount);
+        setParameter(processor, Parameters::nameDryLevel, wet ? 0.0f : 1.0f);
+        setParameter(processor, Parameters::nameWetLevel, wet ? 0.9f : 0.0f);
+
+        processor.prepareToPlay(sampleRate, BLOCK_SIZE);
+
+        juce::MidiBuffer midi;
+
+        // La IR arriva dal thread del designer: si misura a IR caricata
+        if (disperserCase.mode == 1)
+            waitForDesign(processor, midi);
+
+        const double lag = measureProbeLag(sampleRate, [&](juce::AudioBuffer<float>& block)
+        {
+            processor.processBlock(block, midi);
+        });
+
+        processor.releaseResources();
+
+        // Solo il wet passa dal DC blocker (highpass RBJ a 7.5Hz come in
+        // WaveshaperCore, fase in anticipo)
+        const double omega = juce::MathConstants<double>::twoPi * PROBE_FREQUENCY / sampleRate;
+        double knownLag = disperserLag;
+        if (wet)
+            knownLag -= juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 7.5)->getPhaseForFrequency(PROBE_FREQUENCY, sampleRate);
+
+        const double period = sampleRate / PROBE_FREQUENCY;
+        const double error = (lag - knownLag) / omega - processor.getLatencySamples();
+        return error - period * std::round(error / period);
+    }
+
+    /**
+     * [user-018] Latenza riportata contro ritardo misurato dell'intera
+     * catena. Errore in sample (wet e dry per ordine ADAA), per ogni
+     * configurazione, modalità del disperser e sample rate.
+     */
+    static void runLatency()
+    {
+        double maxError = 0.0;
+
+        for (const double sampleRate : SAMPLE_RATES)
+        {
+            for (const auto& disperserCase : DISPERSER_CASES)
+            {
+                const double disperserLag = measureDisperserLag(sampleRate, disperserCase);
+
+                Benchmark::printHeader("[user-018] latency error at " + juce::String(sampleRate / 1000.0, 1) + " kHz, disperser "
+                                           + disperserCase.name + ", tilt " + juce::String(TILT, 0) + " dB",
+                                       "  samples (measured - reported)   off wet   off dry  ADAA1 wet ADAA1 dry ADAA2 wet ADAA2 dry");
+
+                for (const auto& oversamplingCase : OVERSAMPLING_CASES)
+                {
+                    double errors[6] = {};
+                    for (int adaaOrder = 0; adaaOrder < 3; ++adaaOrder)
+                    {
+                        for (const bool wet : { true, false })
+                        {
+                            const double error = measureLatencyError(sampleRate, oversamplingCase, adaaOrder, disperserCase, disperserLag, wet);
+                            errors[adaaOrder * 2 + (wet ? 0 : 1)] = error;
+                            maxError = juce::jmax(maxError, std::abs(error));
+                        }
+                    }
+
+                    Benchmark::printRow(oversamplingCase.name, { errors[0], errors[1], errors[2], errors[3], errors[4], errors[5] }, 3);
+                }
+            }
+        }
+
+        Benchmark::printNote(juce::String(maxError < LATENCY_TOLERANCE ? "OK" : "FAIL") + ": max |error| "
+                             + juce::String(maxError, 3) + " samples, tolerance " + juce::String(LATENCY_TOLERANCE, 2));
+    }
+};
@@ -0,0 +1,439 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "../../Source/Filters.h"
+#include "../../Source/Disperser.h"
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * FILTER BENCHMARKS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * - Tilt e DC blocker su BiquadCascade (canali come lane, gain fuso nello
+ *   stesso passaggio) contro i juce::dsp::IIR::Filter per canale e per
+ *   sample originali, riprodotti qui come riferimento: stessa uscita entro
+ *   FILTER_TOLERANCE, poi il costo
+ * - Disperser in modalità Cascade: costo per numero di stadi, con
+ *   coefficienti fermi e con la modulazione dall'envelope
+ * - Disperser in modalità Convolution contro Cascade con gli stessi
+ *   amount, stadi e frequenza
+ */
+struct FilterBenchmarks
+{
+    static constexpr double SAMPLE_RATE = 48000.0;
+    static constexpr int BLOCK_SIZE = 512;
+    static constexpr int NUM_CHANNELS = 2;
+    static constexpr int NUM_CHECK_BLOCKS = 64;
+    static constexpr float FILTER_TOLERANCE = 1.0e-5f;
+    static constexpr float PIVOT_FREQUENCY = 500.0f;
+
+    // ═══════════════════════════════════════════════════════════
+    // RIFERIMENTO: TiltFilter originale (low shelf + high shelf
+    // juce::dsp::IIR::Filter per canale, gain applicato per sample)
+    // ═══════════════════════════════════════════════════════════
+    struct ReferenceTilt
+    {
+        ReferenceTilt()
+        {
+            lowCoefficients = new juce::dsp::IIR::Coefficients<float>(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+            highCoefficients = new juce::dsp::IIR::Coefficients<float>(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                lowShelf[ch].coefficients = lowCoefficients;
+                highShelf[ch].coefficients = highCoefficients;
+            }
+        }
+
+        void prepare(double sampleRate, float initialTilt)
+        {
+            tiltAmount.reset(sampleRate, 0.005);
+            tiltAmount.setCurrentAndTargetValue(initialTilt);
+            lastTiltAmount = initialTilt;
+
+            const double omega = juce::MathConstants<double>::twoPi * PIVOT_FREQUENCY / sampleRate;
+            cosOmega = std::cos(omega);
+            sinOmegaOverQ = std::sin(omega) / Q;
+
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                lowShelf[ch].reset();
+                highShelf[ch].reset();
+            }
+
+            updateCoefficients(initialTilt);
+        }
+
+        void setTiltAmount(float tiltDB)
+        {
+            tiltAmount.setTargetValue(juce::jlimit(-12.0f, 12.0f, tiltDB));
+        }
+
+        void processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+        {
+            for (int start = 0; start < numSamples; start += CONTROL_RATE)
+            {
+                const int count = juce::jmin(CONTROL_RATE, numSamples - start);
+                const float startTilt = tiltAmount.getCurrentValue();
+                const float endTilt = tiltAmount.isSmoothing() ? tiltAmount.skip(count) : startTilt;
+
+                if (std::abs(endTilt - lastTiltAmount) > 0.001f)
+                {
+                    updateCoefficients(endTilt);
+                    lastTiltAmount = endTilt;
+                }
+
+                const float startGain = 1 - std::abs(startTilt) * 0.01f;
+                const float gainStep = ((1 - std::abs(endTilt) * 0.01f) - startGain) / static_cast<float>(count);
+
+                for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                {
+                    float* channelData = buffer.getWritePointer(ch, start);
+
+                    for (int i = 0; i < count; ++i)
+                    {
+                        float sample = channelData[i];
+
+                        sample = lowShelf[ch].processSample(sample);
+                        sample = highShelf[ch].processSample(sample);
+                        sample *= startGain + gainStep * static_cast<float>(i + 1);
+                        channelData[i] = sample;
+                    }
+                }
+            }
+        }
+
+    private:
+        static constexpr int CONTROL_RATE = 16;
+        static constexpr float Q = 0.707f;
+
+        void updateCoefficients(float currentTilt)
+        {
+            const double A = std::pow(10.0, currentTilt / 40.0);
+
+            writeShelf(lowCoefficients->getRawCoefficients(), A, false);
+            writeShelf(highCoefficients->getRawCoefficients(), 1.0 / A, true);
+        }
+
+        void writeShelf(float* raw, double A, bool isHighShelf) const noexcept
+        {
+            const double aMinus1 = A - 1.0;
+            const double aPlus1 = A + 1.0;
+            const double beta = sinOmegaOverQ * std::sqrt(A);
+            const double s = isHighShelf ? -1.0 : 1.0;
+            const double sTimesAMinus1Cos = s * aMinus1 * cosOmega;
+
+            const double b0 = A * (aPlus1 - sTimesAMinus1Cos + beta);
+            const double b1 = s * 2.0 * A * (aMinus1 - s * aPlus1 * cosOmega);
+            const double b2 = A * (aPlus1 - sTimesAMinus1Cos - beta);
+            const double a0 = aPlus1 + sTimesAMinus1Cos + beta;
+            const double a1 = -s * 2.0 * (aMinus1 + s * aPlus1 * cosOmega);
+            const double a2 = aPlus1 + sTimesAMinus1Cos - beta;
+
+            const double invA0 = 1.0 / a0;
+            raw[0] = static_cast<float>(b0 * invA0);
+            raw[1] = static_cast<float>(b1 * invA0);
+            raw[2] = static_cast<float>(b2 * invA0);
+            raw[3] = static_cast<float>(a1 * invA0);
+            raw[4] = static_cast<float>(a2 * invA0);
+        }
+
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> tiltAmount;
+        float lastTiltAmount = 0.0f;
+        double cosOmega = 1.0;
+        double sinOmegaOverQ = 0.0;
+        juce::dsp::IIR::Coefficients<float>::Ptr lowCoefficients;
+        juce::dsp::IIR::Coefficients<float>::Ptr highCoefficients;
+        juce::dsp::IIR::Filter<float> lowShelf[NUM_CHANNELS];
+        juce::dsp::IIR::Filter<float> highShelf[NUM_CHANNELS];
+    };
+
+    // Riferimento del DC blocker: highpass per canale, poi gain in un secondo passaggio
+    struct ReferenceDCBlocker
+    {
+        void prepare(double sampleRate)
+        {
+            auto coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 7.5);
+            for (auto& filter : filters)
+            {
+                filter.coefficients = coefficients;
+                filter.reset();
+            }
+        }
+
+        void process(juce::AudioBuffer<float>& buffer, int numSamples)
+        {
+            auto bufferData = buffer.getArrayOfWritePointers();
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    bufferData[ch][i] = filters[ch].processSample(bufferData[ch][i]);
+                    bufferData[ch][i] *= 0.5f;
+                }
+            }
+        }
+
+        juce::dsp::IIR::Filter<float> filters[NUM_CHANNELS];
+    };
+
+    // Tilt fermo a +6 dB, oppure una rampa ±12 dB ricominciata a ogni blocco
+    struct TiltCase
+    {
+        const char* name;
+        bool rampEveryBlock;
+    };
+
+    static constexpr TiltCase TILT_CASES[] = {
+        { "tilt static +6 dB", false },
+        { "tilt ramp +-12 dB every block", true }
+    };
+
+    static float tiltForBlock(const TiltCase& tiltCase, int blockIndex)
+    {
+        return tiltCase.rampEveryBlock ? ((blockIndex & 1) != 0 ? 12.0f : -12.0f) : 6.0f;
+    }
+
+    static float maxAbsDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float difference = 0.0f;
+
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                difference = juce::jmax(difference, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+
+        return difference;
+    }
+
+    /**
+     * Esegue reference e current sugli stessi NUM_CHECK_BLOCKS blocchi e ne
+     * confronta l'uscita, poi misura entrambi. Gli step ricevono il buffer e
+     * l'indice del blocco (per i cambi di parametro).
+     */
+    template <typename ReferenceStep, typename CurrentStep>
+    static void compareFilters(const juce::String& label, const juce::AudioBuffer<float>& source,
+                               ReferenceStep&& referenceStep, CurrentStep&& currentStep)
+    {
+        juce::AudioBuffer<float> referenceBuffer(NUM_CHANNELS, BLOCK_SIZE);
+        juce::AudioBuffer<float> currentBuffer(NUM_CHANNELS, BLOCK_SIZE);
+        float maxDifference = 0.0f;
+
+        for (int block = 0; block < NUM_CHECK_BLOCKS; ++block)
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                referenceBuffer.copyFrom(ch, 0, source, ch, block * BLOCK_SIZE, BLOCK_SIZE);
+                currentBuffer.copyFrom(ch, 0, source, ch, block * BLOCK_SIZE, BLOCK_SIZE);
+            }
+
+            referenceStep(referenceBuffer, block);
+            currentStep(currentBuffer, block);
+            maxDifference = juce::jmax(maxDifference, maxAbsDifference(referenceBuffer, currentBuffer));
+        }
+
+        // Costo: sempre lo stesso blocco d'ingresso, lo stato dei filtri prosegue
+        int referenceBlock = 0;
+        const double before = Benchmark::measureNsPerSample(BLOCK_SIZE, [&]
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                referenceBuffer.copyFrom(ch, 0, source, ch, 0, BLOCK_SIZE);
+            referenceStep(referenceBuffer, referenceBlock++);
+        });
+
+        int currentBlock = 0;
+        const double after = Benchmark::measureNsPerSample(BLOCK_SIZE, [&]
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                currentBuffer.copyFrom(ch, 0, source, ch, 0, BLOCK_SIZE);
+            currentStep(currentBuffer, currentBlock++);
+        });
+
+        Benchmark::printRow(label, { before, after, before / after, maxDifference * 1.0e6 });
+
+        if (maxDifference >= FILTER_TOLERANCE)
+            Benchmark::printNote("FAIL: output differs from the reference by more than "
+                                 + juce::String(FILTER_TOLERANCE * 1.0e6f, 0) + "e-6");
+    }
+
+    /**
+     * [user-010] BiquadCascade (tilt: 2 sezioni + gain, DC blocker: 1
+     * sezione + 0.5) contro gli IIR::Filter per canale originali.
+     * ns per sample stereo; la differenza d'uscita è in unità di 1e-6.
+     */
+    static void runBiquadCascade()
+    {
+        juce::AudioBuffer<float> source(NUM_CHANNELS, BLOCK_SIZE * NUM_CHECK_BLOCKS);
+        Benchmark::fillSignal(source, 0.5f);
+
+        Benchmark::printHeader("[user-010] tilt and DC blocker, stereo, " + juce::String(BLOCK_SIZE) + "-sample blocks",
+                               "  ns per stereo sample            reference   current   speedup  diff 1e-6");
+
+        for (const auto& tiltCase : TILT_CASES)
+        {
+            ReferenceTilt reference;
+            reference.prepare(SAMPLE_RATE, tiltForBlock(tiltCase, 0));
+
+            TiltFilter current(tiltForBlock(tiltCase, 0), PIVOT_FREQUENCY);
+            current.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE);
+
+            compareFilters(tiltCase.name, source,
+                           [&](juce::AudioBuffer<float>& buffer, int block)
+                           {
+                               reference.setTiltAmount(tiltForBlock(tiltCase, block + 1));
+                               reference.processBlock(buffer, BLOCK_SIZE);
+                           },
+                           [&](juce::AudioBuffer<float>& buffer, int block)
+                           {
+                               current.setTiltAmount(tiltForBlock(tiltCase, block + 1));
+                               current.processBlock(buffer, BLOCK_SIZE);
+                           });
+        }
+
+        ReferenceDCBlocker reference;
+        reference.prepare(SAMPLE_RATE);
+
+        BiquadCascade<1> current;
+        current.setSection(0, *juce::dsp::IIR::Coefficients<float>::makeHighPass(SAMPLE_RATE, 7.5));
+
+        compareFilters("DC blocker + 0.5 gain", source,
+                       [&](juce::AudioBuffer<float>& buffer, int)
+                       {
+                           reference.process(buffer, BLOCK_SIZE);
+                       },
+                       [&](juce::AudioBuffer<float>& buffer, int)
+                       {
+                           current.process(buffer.getArrayOfWritePointers(), NUM_CHANNELS, BLOCK_SIZE, 0.5f);
+                       });
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // DISPERSER (user-012)
+    // ═══════════════════════════════════════════════════════════
+    static constexpr int STAGE_COUNTS[] = { 4, 16, 32, 64, 128 };
+
+    static double measureDisperser(int numStages, int blockSize, float envModAmount)
+    {
+        Disperser disperser(0.7f, 1000.0f, 1.0f);
+        disperser.setNumStages(numStages);
+        disperser.setEnvModAmount(envModAmount);
+        disperser.prepareToPlay(SAMPLE_RATE, blockSize, NUM_CHANNELS);
+
+        juce::AudioBuffer<float> source(NUM_CHANNELS, blockSize);
+        Benchmark::fillSignal(source, 0.5f);
+
+        juce::AudioBuffer<float> envelope(1, blockSize);
+        for (int i = 0; i < blockSize; ++i)
+            envelope.setSample(0, i, 0.5f + 0.5f * std::sin(0.05f * static_cast<float>(i)));
+
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, blockSize);
+
+        // Stesso numero di sample per ripetizione con ogni dimensione di blocco
+        return Benchmark::measureNsPerSample(blockSize, [&]
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, blockSize);
+            disperser.processBlock(buffer, envelope);
+        }, 64 * BLOCK_SIZE / blockSize);
+    }
+
+    /**
+     * [user-012] Costo della cascata del Disperser per numero di stadi,
+     * ns per sample stereo. La cascata è l'unico costo che cresce con gli
+     * stadi: la modalità Convolution ha costo fisso.
+     */
+    static void runDisperserStages()
+    {
+        juce::String columns = "  ns per stereo sample          ";
+        for (const int stages : STAGE_COUNTS)
+            columns += juce::String(stages).paddedLeft(' ', 10);
+
+        Benchmark::printHeader("[user-012] disperser cascade by stage count, stereo", columns);
+
+        for (const int blockSize : { BLOCK_SIZE, 64 })
+        {
+            for (const float envModAmount : { 0.0f, 0.5f })
+            {
+                const juce::String label = juce::String(blockSize) + "-sample blocks, "
+                                           + (envModAmount == 0.0f ? "static" : "env mod");
+
+                Benchmark::printRow(label, { measureDisperser(STAGE_COUNTS[0], blockSize, envModAmount),
+                                             measureDisperser(STAGE_COUNTS[1], blockSize, envModAmount),
+                                             measureDisperser(STAGE_COUNTS[2], blockSize, envModAmount),
+                                             measureDisperser(STAGE_COUNTS[3], blockSize, envModAmount),
+                                             measureDisperser(STAGE_COUNTS[4], blockSize, envModAmount) }, 1);
+            }
+        }
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // DISPERSER: CONVOLUTION CONTRO CASCADE (user-013)
+    // ═══════════════════════════════════════════════════════════
+    static constexpr int MODE_STAGE_COUNTS[] = { 8, 32, 128 };
+    static constexpr float MODE_AMOUNTS[] = { 0.3f, 0.7f, 1.0f };
+    static constexpr int MODE_WAIT_BLOCKS = 2000;   // Design, caricamento e riscaldamento
+    static constexpr int MODE_FADE_BLOCKS = 4;      // Oltre il crossfade di modalità
+
+    // ns per sample stereo a parametri fermi; in Convolution misura dopo il passaggio
+    static double measureDisperserMode(int numStages, float amount, Disperser::Mode mode)
+    {
+        Disperser disperser(amount, 1000.0f, 1.0f);
+        disperser.setNumStages(numStages);
+        disperser.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE, NUM_CHANNELS);
+
+        juce::AudioBuffer<float> source(NUM_CHANNELS, BLOCK_SIZE);
+        Benchmark::fillSignal(source, 0.5f);
+
+        juce::AudioBuffer<float> envelope(1, BLOCK_SIZE);
+        envelope.clear();
+
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, BLOCK_SIZE);
+        const auto process = [&]
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, BLOCK_SIZE);
+            disperser.updateConfiguration();
+            disperser.processBlock(buffer, envelope);
+        };
+
+        // Passaggio a Convolution completato (latenza riportata, crossfade finito)
+        if (mode == Disperser::Mode::Convolution)
+        {
+            disperser.setMode(1);
+            for (int block = 0; block < MODE_WAIT_BLOCKS && disperser.getLatencySamples() == 0; ++block)
+            {
+                process();
+                juce::Thread::sleep(1);
+            }
+
+            jassert(disperser.getLatencySamples() > 0);
+            for (int block = 0; block < MODE_FADE_BLOCKS; ++block)
+                process();
+        }
+
+        return Benchmark::measureNsPerSample(BLOCK_SIZE, process, 32);
+    }
+
+    /**
+     * [user-013] Convolution contro Cascade con gli stessi parametri, ns per
+     * sample stereo. Il costo della convoluzione segue la lunghezza della IR
+     * (stadi, amount e frequenza), non il numero di stadi in sé.
+     */
+    static void runDisperserModes()
+    {
+        Benchmark::printHeader("[user-013] disperser Convolution vs Cascade, stereo, 1 kHz, "
+                                   + juce::String(BLOCK_SIZE) + "-sample blocks",
+                               "  ns per stereo sample             cascade  convolut.  conv/casc");
+
+        for (const int stages : MODE_STAGE_COUNTS)
+        {
+            for (const float amount : MODE_AMOUNTS)
+            {
+                const double cascade = measureDisperserMode(stages, amount, Disperser::Mode::Cascade);
+                const double convolution = measureDisperserMode(stages, amount, Disperser::Mode::Convolution);
+
+                Benchmark::printRow(juce::String(stages) + " stages, amount " + juce::String(amount, 1),
+                                    { cascade, convolution, convolution / cascade }, 1);
+            }
+        }
+    }
+};
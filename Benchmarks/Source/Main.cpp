@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    SubSaverBenchmarks: benchmark e verifiche dei moduli DSP di SubSaver.
+
+    Uso:  SubSaverBenchmarks [--list] [nome ...]
+    Senza argomenti esegue tutto. Da compilare in Release: i numeri di una
+    build Debug non sono significativi.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ShaperBenchmarks.h"
+#include "FilterBenchmarks.h"
+#include "PoolBenchmarks.h"
+#include "ChainChecks.h"
+
+namespace
+{
+    struct Entry
+    {
+        const char* name;
+        const char* description;
+        void (*run)();
+    };
+
+    const Entry entries[] = {
+        { "shaper", "[user-001] SIMD shaping kernel vs original scalar loop", ShaperBenchmarks::runShapingKernel },
+        { "ramps", "[user-008] per-block parameter ramps vs per-sample smoothing", ShaperBenchmarks::runParameterRamps },
+        { "tables", "[user-003] Hermite tables vs libm vs SIMD polynomials", ShaperBenchmarks::runTransferTables },
+        { "foldback", "[user-005] closed-form foldback vs while loop, worst case", ShaperBenchmarks::runFoldback },
+        { "adaa", "[user-004] ADAA accuracy and cost per shape, factor and order", ShaperBenchmarks::runAntiAliasing },
+        { "biquads", "[user-010] BiquadCascade tilt and DC blocker vs per-channel IIR filters", FilterBenchmarks::runBiquadCascade },
+        { "disperser", "[user-012] disperser cascade cost by stage count", FilterBenchmarks::runDisperserStages },
+        { "convolution", "[user-013] disperser Convolution vs Cascade at matched settings", FilterBenchmarks::runDisperserModes },
+        { "pool", "[user-025] disperser cascade serial vs WorkerPool, idle worker CPU", PoolBenchmarks::runWorkerPool },
+        { "poolchain", "[user-025] whole processBlock at 16x, serial vs Multithread, 2 and 16 ch", PoolBenchmarks::runChain },
+        { "latency", "[user-018] reported latency vs measured whole-chain delay", ChainChecks::runLatency }
+    };
+
+    void printList()
+    {
+        for (const auto& entry : entries)
+            std::cout << juce::String(entry.name).paddedRight(' ', 16) << entry.description << "\n";
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::StringArray requested;
+    for (int i = 1; i < argc; ++i)
+        requested.add(argv[i]);
+
+    if (requested.contains("--list"))
+    {
+        printList();
+        return 0;
+    }
+
+    int numRun = 0;
+    for (const auto& entry : entries)
+    {
+        if (requested.isEmpty() || requested.contains(entry.name))
+        {
+            entry.run();
+            ++numRun;
+        }
+    }
+
+    if (numRun == 0)
+    {
+        std::cout << "Nessun benchmark con questo nome. Disponibili:\n";
+        printList();
+        return 1;
+    }
+
+    return 0;
+}
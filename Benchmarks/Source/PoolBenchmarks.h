@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "../../Source/Disperser.h"
+#include "../../Source/WorkerPool.h"
+#include "../../Source/PluginProcessor.h"
+#include <ctime>
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * POOL BENCHMARKS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Modalità Multithread: costo della cascata del disperser (il lavoro per
+ * canale più pesante) in serie e sul WorkerPool con 0-7 worker, e CPU
+ * consumata dai worker parcheggiati, finito lo spin (due blocchi, come
+ * nel plugin) dopo l'ultimo job.
+ *
+ * Poi l'intero processBlock a 16x, in serie e in modalità Multithread, a
+ * 2 e 16 canali: il pool del plugin ha un worker per canale oltre il
+ * primo, nei limiti dei core. Tilt e DC blocker dividono i canali in
+ * gruppi di PARALLEL_LANES (4): sotto i 5 canali restano sull'audio
+ * thread, a 2 canali lavorano sul pool solo shaping e disperser.
+ *
+ * Lo speedup dipende dai core liberi: con meno core che worker i thread
+ * si contendono la CPU e i numeri misurano solo l'overhead di dispatch e
+ * risveglio. La riga di intestazione riporta i core visti dal processo.
+ */
+struct PoolBenchmarks
+{
+    static constexpr double SAMPLE_RATE = 48000.0;
+    static constexpr int NUM_CHANNELS = 16;          // 4 gruppi di lane: 4 task per blocco
+    static constexpr int NUM_STAGES = 32;
+    static constexpr int BLOCK_SIZE = 512;
+    static constexpr int WORKER_COUNTS[] = { 0, 1, 3, 7 };
+    static constexpr int CHAIN_CHANNELS[] = { 2, 16 };
+    static constexpr int CHAIN_FACTOR_INDEX = 4;        // 16x
+    static constexpr int IDLE_MS = 200;
+    static constexpr int SPIN_MS = 2 * 1000 * BLOCK_SIZE / static_cast<int>(SAMPLE_RATE) + 1;
+
+    // ns per sample (tutti i canali) della cascata, pool nullptr = in serie
+    static double measureCascade(WorkerPool* pool, int blockSize)
+    {
+        Disperser disperser(0.7f, 1000.0f, 1.0f);
+        disperser.setNumStages(NUM_STAGES);
+        disperser.setEnvModAmount(0.5f);
+        disperser.prepareToPlay(SAMPLE_RATE, blockSize, NUM_CHANNELS);
+        disperser.setWorkerPool(pool);
+
+        juce::AudioBuffer<float> source(NUM_CHANNELS, blockSize);
+        Benchmark::fillSignal(source, 0.5f);
+
+        juce::AudioBuffer<float> envelope(1, blockSize);
+        for (int i = 0; i < blockSize; ++i)
+            envelope.setSample(0, i, 0.5f + 0.5f * std::sin(0.05f * static_cast<float>(i)));
+
+        juce::AudioBuffer<float> buffer(NUM_CHANNELS, blockSize);
+
+        return Benchmark::measureNsPerSample(blockSize, [&]
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, blockSize);
+            disperser.processBlock(buffer, envelope);
+        }, 64 * BLOCK_SIZE / blockSize);
+    }
+
+    // CPU del processo (ms) in IDLE_MS di attesa, a spin finito: i worker parcheggiati
+    static double measureIdleCpu(WorkerPool& pool)
+    {
+        pool.parallelFor(NUM_CHANNELS, [](int) {});
+        juce::Thread::sleep(SPIN_MS * 4);
+
+        const auto start = std::clock();
+        juce::Thread::sleep(IDLE_MS);
+        return 1000.0 * static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    }
+
+    // ns per sample (tutti i canali) dell'intero processBlock a 16x
+    static double measureChain(int numChannels, bool multithread)
+    {
+        SubSaverAudioProcessor processor;
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+        const bool layoutSupported = processor.setBusesLayout(layout);
+        jassert(layoutSupported);
+        juce::ignoreUnused(layoutSupported);
+
+        processor.setRateAndBufferSizeDetails(SAMPLE_RATE, BLOCK_SIZE);
+
+        const auto setParameter = [&](const juce::String& name, float value)
+        {
+            auto* parameter = processor.parameters.getParameter(name);
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        };
+
+        setParameter(Parameters::nameOversampling, 1.0f);
+        setParameter(Parameters::nameOversamplingFactor, static_cast<float>(CHAIN_FACTOR_INDEX));
+        setParameter(Parameters::nameMultithread, multithread ? 1.0f : 0.0f);
+
+        processor.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE);
+
+        juce::AudioBuffer<float> source(numChannels, BLOCK_SIZE);
+        Benchmark::fillSignal(source, 0.5f);
+
+        juce::AudioBuffer<float> buffer(numChannels, BLOCK_SIZE);
+        juce::MidiBuffer midi;
+
+        const double result = Benchmark::measureNsPerSample(BLOCK_SIZE, [&]
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, BLOCK_SIZE);
+            processor.processBlock(buffer, midi);
+        }, 16);
+
+        processor.releaseResources();
+        return result;
+    }
+
+    /**
+     * [user-025] Intero processBlock a 16x in serie e in modalità
+     * Multithread, ns per sample di tutti i canali.
+     */
+    static void runChain()
+    {
+        Benchmark::printHeader("[user-025] whole processBlock, 16x, " + juce::String(BLOCK_SIZE) + "-sample blocks, "
+                                   + juce::String(juce::SystemStats::getNumCpus()) + " CPU",
+                               juce::String("  ns per sample (all channels)").paddedRight(' ', 32)
+                                   + "    serial      pool   speedup");
+
+        for (const int numChannels : CHAIN_CHANNELS)
+        {
+            // Worker del pool del plugin (startWorkerPool)
+            const int numWorkers = juce::jmax(0, juce::jmin(juce::SystemStats::getNumCpus() - 1, numChannels - 1));
+
+            const double serial = measureChain(numChannels, false);
+            const double pooled = measureChain(numChannels, true);
+
+            Benchmark::printRow(juce::String(numChannels) + " ch, " + juce::String(numWorkers) + " wrk",
+                                { serial, pooled, serial / pooled }, 1);
+        }
+    }
+
+    /**
+     * [user-025] Cascata del disperser in serie e sul WorkerPool, ns per
+     * sample di tutti i canali; CPU dei worker fermi.
+     */
+    static void runWorkerPool()
+    {
+        juce::String workerColumns;
+        for (const int workers : WORKER_COUNTS)
+            workerColumns += (juce::String(workers) + " wrk").paddedLeft(' ', 10);
+
+        const auto columns = juce::String("  ns per sample (all channels)").paddedRight(' ', 32)
+                             + juce::String("serial").paddedLeft(' ', 10) + workerColumns;
+
+        Benchmark::printHeader("[user-025] disperser cascade, " + juce::String(NUM_CHANNELS) + " ch, "
+                                   + juce::String(NUM_STAGES) + " stages, env mod, "
+                                   + juce::String(juce::SystemStats::getNumCpus()) + " CPU",
+                               columns);
+
+        WorkerPool pools[std::size(WORKER_COUNTS)];
+        for (size_t i = 0; i < std::size(WORKER_COUNTS); ++i)
+        {
+            pools[i].setSpinTime(SPIN_MS * 0.001);
+            pools[i].start(WORKER_COUNTS[i]);
+        }
+
+        for (const int blockSize : { BLOCK_SIZE, 64 })
+        {
+            Benchmark::printRow(juce::String(blockSize) + "-sample blocks",
+                                { measureCascade(nullptr, blockSize),
+                                  measureCascade(&pools[0], blockSize),
+                                  measureCascade(&pools[1], blockSize),
+                                  measureCascade(&pools[2], blockSize),
+                                  measureCascade(&pools[3], blockSize) }, 1);
+        }
+
+        Benchmark::printHeader("[user-025] parked workers, process CPU in " + juce::String(IDLE_MS) + " ms after the "
+                                   + juce::String(SPIN_MS) + " ms spin",
+                               juce::String("  CPU ms").paddedRight(' ', 32) + workerColumns);
+
+        Benchmark::printRow("parked", { measureIdleCpu(pools[0]), measureIdleCpu(pools[1]),
+                                                    measureIdleCpu(pools[2]), measureIdleCpu(pools[3]) }, 1);
+    }
+};
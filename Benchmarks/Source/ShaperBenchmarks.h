@@ -0,0 +1,783 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "../../Source/Saturators.h"
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * SHAPER BENCHMARKS
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * - Stadio sovracampionato di WaveshaperCore (rampe dei parametri + shaping,
+ *   senza i filtri di oversampling) confrontato con il loop scalare
+ *   originale, riprodotto qui come riferimento
+ * - Rampe dei parametri per blocco contro lo smoothing per sample
+ * - Curve di trasferimento: tabelle di WaveshapeTables, libm e kernel SIMD,
+ *   velocità ed errore contro la funzione analitica
+ * - Foldback: forma chiusa contro il while originale, equivalenza e caso
+ *   peggiore
+ * - ADAA: accuratezza del primo ordine vettoriale contro l'originale
+ *   double, costo per forma, fattore e ordine
+ *
+ * ShaperBenchmarks è friend di WaveshaperCore: misura le stesse funzioni
+ * chiamate da processBlock.
+ */
+struct ShaperBenchmarks
+{
+    static constexpr double SAMPLE_RATE = 48000.0;
+    static constexpr int BLOCK_SIZE = 512;
+    static constexpr int NUM_CHANNELS = 2;
+
+    // ═══════════════════════════════════════════════════════════
+    // RIFERIMENTO: loop scalare originale (un campione sovracampionato
+    // alla volta, smoothing per campione, tutte e 4 le forme con libm)
+    // ═══════════════════════════════════════════════════════════
+    struct ReferenceShaper
+    {
+        static float chebyshevPoly(float x)
+        {
+            x = std::tanh(x);
+            return 3.0f * x - 4.0f * x * x * x;
+        }
+
+        static float sineFold(float x)
+        {
+            return std::sin(juce::MathConstants<float>::twoPi * x);
+        }
+
+        static float triangleWavefolder(float x)
+        {
+            const float phase = x + 0.25f;
+            return 4.0f * std::abs(phase - std::floor(phase + 0.5f)) - 1.0f;
+        }
+
+        static float foldback(float x)
+        {
+            constexpr float threshold = 0.125f;
+            constexpr float gainComp = 1.0f / threshold;
+
+            while (x > threshold || x < -threshold)
+            {
+                if (x > threshold)
+                    x = threshold - (x - threshold);
+                if (x < -threshold)
+                    x = -threshold + (-threshold - x);
+            }
+
+            return x * gainComp;
+        }
+
+        static float applyWaveshaping(float x, float morph)
+        {
+            const float shape0 = chebyshevPoly(x);
+            const float shape1 = sineFold(x);
+            const float shape2 = triangleWavefolder(x);
+            const float shape3 = foldback(x);
+
+            if (morph < 1.0f)
+                return shape0 * (1.0f - morph) + shape1 * morph;
+            if (morph < 2.0f)
+                return shape1 * (2.0f - morph) + shape2 * (morph - 1.0f);
+            return shape2 * (3.0f - morph) + shape3 * (morph - 2.0f);
+        }
+
+        void prepare(double sampleRate)
+        {
+            drive.reset(sampleRate, 0.03);
+            stereoWidth.reset(sampleRate, 0.03);
+            morphValue.reset(sampleRate, 0.25);
+        }
+
+        void process(juce::dsp::AudioBlock<float>& oversampledBlock, const float* envData, int factor)
+        {
+            const bool morphIsSmoothing = morphValue.isSmoothing();
+            const bool driveIsSmoothing = drive.isSmoothing();
+            const bool stereoIsSmoothing = stereoWidth.isSmoothing();
+            float currentMorph = morphValue.getCurrentValue();
+            double currentDrive = drive.getCurrentValue();
+            double currentWidth = stereoWidth.getCurrentValue();
+
+            for (size_t sample = 0; sample < oversampledBlock.getNumSamples(); ++sample)
+            {
+                if (morphIsSmoothing && (sample % static_cast<size_t>(factor) == 0))
+                    currentMorph = morphValue.getNextValue();
+                if (driveIsSmoothing && (sample % static_cast<size_t>(factor) == 0))
+                    currentDrive = drive.getNextValue();
+                if (stereoIsSmoothing && (sample % static_cast<size_t>(factor) == 0))
+                    currentWidth = stereoWidth.getNextValue();
+
+                const float env = envData[sample / static_cast<size_t>(factor)] + 1.0f;
+                const float biasL = static_cast<float>(currentWidth) * -0.5f;
+                const float biasR = static_cast<float>(currentWidth) * 0.5f;
+
+                for (size_t ch = 0; ch < oversampledBlock.getNumChannels(); ++ch)
+                {
+                    auto* data = oversampledBlock.getChannelPointer(ch);
+                    float driven = data[sample] * static_cast<float>(currentDrive);
+                    driven += (ch == 0) ? biasL : biasR;
+                    driven *= env;
+                    data[sample] = applyWaveshaping(driven, currentMorph);
+                }
+            }
+        }
+
+        juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> drive;
+        juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> stereoWidth;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> morphValue;
+    };
+
+    /** Caso di morph misurato: statico (intero o tra due forme) o in smoothing */
+    struct MorphCase
+    {
+        const char* name;
+        float start;
+        float target;
+    };
+
+    static constexpr MorphCase MORPH_CASES[] = {
+        { "single shape (1.0)",       1.0f, 1.0f },
+        { "static blend (1.5)",       1.5f, 1.5f },
+        { "ramp in segment (1.2-1.8)", 1.2f, 1.8f },
+        { "ramp across (0.5-2.5)",    0.5f, 2.5f }
+    };
+
+    template <typename Smoothed, typename Value>
+    static void startRamp(Smoothed& smoothed, Value start, Value target)
+    {
+        smoothed.setCurrentAndTargetValue(start);
+        smoothed.setTargetValue(target);
+    }
+
+    // Stadio sovracampionato di WaveshaperCore per un fattore: rampe + shaping
+    template <int Factor>
+    static double measureCore(WaveshaperCore& core, const MorphCase& morph, int adaaOrder,
+                              juce::AudioBuffer<float>& oversampled, const juce::AudioBuffer<float>& source,
+                              const float* envData, double driveStart = 4.0, double driveTarget = 6.0)
+    {
+        juce::dsp::AudioBlock<float> block(oversampled);
+        auto oversampledBlock = block.getSubBlock(0, static_cast<size_t>(BLOCK_SIZE * Factor));
+
+        return Benchmark::measureNsPerSample(BLOCK_SIZE, [&]
+        {
+            oversampled.copyFrom(0, 0, source, 0, 0, BLOCK_SIZE * Factor);
+            oversampled.copyFrom(1, 0, source, 1, 0, BLOCK_SIZE * Factor);
+
+            startRamp(core.morphValue, morph.start, morph.target);
+            startRamp(core.drive, driveStart, driveTarget);
+            startRamp(core.stereoWidth, 0.0, 0.2);
+
+            const bool morphIsSmoothing = core.morphValue.isSmoothing();
+            core.renderParameterRamps(envData, BLOCK_SIZE);
+            core.shapeOversampled<Factor>(oversampledBlock, BLOCK_SIZE, morphIsSmoothing, adaaOrder);
+        });
+    }
+
+    template <int Factor>
+    static double measureReference(ReferenceShaper& reference, const MorphCase& morph,
+                                   juce::AudioBuffer<float>& oversampled, const juce::AudioBuffer<float>& source,
+                                   const float* envData, double driveStart = 4.0, double driveTarget = 6.0)
+    {
+        juce::dsp::AudioBlock<float> block(oversampled);
+        auto oversampledBlock = block.getSubBlock(0, static_cast<size_t>(BLOCK_SIZE * Factor));
+
+        return Benchmark::measureNsPerSample(BLOCK_SIZE, [&]
+        {
+            oversampled.copyFrom(0, 0, source, 0, 0, BLOCK_SIZE * Factor);
+            oversampled.copyFrom(1, 0, source, 1, 0, BLOCK_SIZE * Factor);
+
+            startRamp(reference.morphValue, morph.start, morph.target);
+            startRamp(reference.drive, driveStart, driveTarget);
+            startRamp(reference.stereoWidth, 0.0, 0.2);
+
+            reference.process(oversampledBlock, envData, Factor);
+        });
+    }
+
+    template <int Factor>
+    static void runShapingFactor(WaveshaperCore& core, ReferenceShaper& reference,
+                                 const juce::AudioBuffer<float>& source, const float* envData)
+    {
+        juce::AudioBuffer<float> oversampled(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+
+        for (const auto& morph : MORPH_CASES)
+        {
+            const double before = measureReference<Factor>(reference, morph, oversampled, source, envData);
+            const double after = measureCore<Factor>(core, morph, 0, oversampled, source, envData);
+
+            Benchmark::printRow(juce::String(Factor) + "x " + morph.name, { before, after, before / after });
+        }
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // RAMPE DEI PARAMETRI (user-008)
+    // ═══════════════════════════════════════════════════════════
+
+    // Loop originale senza lo shaping: smoothing per sample, modulo e
+    // divisione per l'indice nativo, drive + bias + envelope
+    static void referenceParameterStage(ReferenceShaper& reference, juce::dsp::AudioBlock<float>& oversampledBlock,
+                                        const float* envData, int factor)
+    {
+        const bool morphIsSmoothing = reference.morphValue.isSmoothing();
+        const bool driveIsSmoothing = reference.drive.isSmoothing();
+        const bool stereoIsSmoothing = reference.stereoWidth.isSmoothing();
+        float currentMorph = reference.morphValue.getCurrentValue();
+        double currentDrive = reference.drive.getCurrentValue();
+        double currentWidth = reference.stereoWidth.getCurrentValue();
+
+        for (size_t sample = 0; sample < oversampledBlock.getNumSamples(); ++sample)
+        {
+            if (morphIsSmoothing && (sample % static_cast<size_t>(factor) == 0))
+                currentMorph = reference.morphValue.getNextValue();
+            if (driveIsSmoothing && (sample % static_cast<size_t>(factor) == 0))
+                currentDrive = reference.drive.getNextValue();
+            if (stereoIsSmoothing && (sample % static_cast<size_t>(factor) == 0))
+                currentWidth = reference.stereoWidth.getNextValue();
+
+            const float env = envData[sample / static_cast<size_t>(factor)] + 1.0f;
+            const float biasL = static_cast<float>(currentWidth) * -0.5f;
+            const float biasR = static_cast<float>(currentWidth) * 0.5f;
+
+            for (size_t ch = 0; ch < oversampledBlock.getNumChannels(); ++ch)
+            {
+                auto* data = oversampledBlock.getChannelPointer(ch);
+                float driven = data[sample] * static_cast<float>(currentDrive);
+                driven += (ch == 0) ? biasL : biasR;
+                data[sample] = driven * env;
+            }
+        }
+
+        juce::ignoreUnused(currentMorph);
+    }
+
+    template <int Factor>
+    static void runParameterFactor(WaveshaperCore& core, ReferenceShaper& reference,
+                                   const juce::AudioBuffer<float>& source, const float* envData, bool smoothing)
+    {
+        juce::AudioBuffer<float> oversampled(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+        juce::dsp::AudioBlock<float> block(oversampled);
+        auto oversampledBlock = block.getSubBlock(0, static_cast<size_t>(BLOCK_SIZE * Factor));
+
+        const float morphTarget = smoothing ? 2.5f : 0.5f;
+        const double driveTarget = smoothing ? 6.0 : 4.0;
+        const double widthTarget = smoothing ? 0.2 : 0.0;
+
+        auto copySource = [&]
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+                oversampled.copyFrom(ch, 0, source, ch, 0, BLOCK_SIZE * Factor);
+        };
+
+        const double before = Benchmark::measureNsPerSample(BLOCK_SIZE, [&]
+        {
+            copySource();
+            startRamp(reference.morphValue, 0.5f, morphTarget);
+            startRamp(reference.drive, 4.0, driveTarget);
+            startRamp(reference.stereoWidth, 0.0, widthTarget);
+            referenceParameterStage(reference, oversampledBlock, envData, Factor);
+        });
+
+        const double after = Benchmark::measureNsPerSample(BLOCK_SIZE, [&]
+        {
+            copySource();
+            startRamp(core.morphValue, 0.5f, morphTarget);
+            startRamp(core.drive, 4.0, driveTarget);
+            startRamp(core.stereoWidth, 0.0, widthTarget);
+
+            // Stessi passi di shapeOversampled prima dello shaping
+            const bool morphIsSmoothing = core.morphValue.isSmoothing();
+            core.renderParameterRamps(envData, BLOCK_SIZE);
+
+            if (morphIsSmoothing)
+                WaveshaperCore::expandRamp<Factor>(core.morphBlock.getChannelPointer(0), core.rampBlock.getChannelPointer(0), BLOCK_SIZE);
+
+            // Il ritorno da shapingBlock al blocco è parte dello shaping: qui si ferma prima
+            for (size_t ch = 0; ch < static_cast<size_t>(NUM_CHANNELS); ++ch)
+                WaveshaperCore::applyDriveRamp<Factor>(core.shapingBlock.getChannelPointer(0), oversampledBlock.getChannelPointer(ch),
+                                                       core.rampBlock.getChannelPointer(1), core.rampBlock.getChannelPointer(2),
+                                                       (ch == 0) ? -1.0f : 1.0f, BLOCK_SIZE);
+        });
+
+        Benchmark::printRow(juce::String(Factor) + (smoothing ? "x all smoothing" : "x static"), { before, after, before / after });
+    }
+
+    /**
+     * [user-008] Rampe per blocco (native, poi espanse per fattore a
+     * compile-time) contro lo smoothing per sample del loop originale.
+     * Solo lo stadio dei parametri: drive, bias della width, envelope e
+     * morph, senza shaping.
+     */
+    static void runParameterRamps()
+    {
+        WaveshaperCore core;
+        core.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE, NUM_CHANNELS);
+
+        ReferenceShaper reference;
+        reference.prepare(SAMPLE_RATE);
+
+        juce::AudioBuffer<float> source(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+        Benchmark::fillSignal(source, 1.0f);
+
+        std::vector<float> envelope(static_cast<size_t>(BLOCK_SIZE));
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+            envelope[static_cast<size_t>(i)] = 0.5f + 0.5f * std::sin(0.01f * static_cast<float>(i));
+
+        Benchmark::printHeader("[user-008] parameter stage (no shaping), stereo, " + juce::String(BLOCK_SIZE) + "-sample blocks",
+                               "  ns per native sample            reference   current   speedup");
+
+        for (const bool smoothing : { false, true })
+        {
+            runParameterFactor<1>(core, reference, source, envelope.data(), smoothing);
+            runParameterFactor<2>(core, reference, source, envelope.data(), smoothing);
+            runParameterFactor<4>(core, reference, source, envelope.data(), smoothing);
+            runParameterFactor<8>(core, reference, source, envelope.data(), smoothing);
+            runParameterFactor<16>(core, reference, source, envelope.data(), smoothing);
+        }
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // TABELLE DI TRASFERIMENTO (user-003)
+    // ═══════════════════════════════════════════════════════════
+    static constexpr int TABLE_PROBES = 1 << 14;
+    static constexpr float TABLE_RANGE = 24.5f;   // drive * env (fino a ±24) più il bias stereo
+
+    struct TransferCase
+    {
+        const char* name;
+        double (*exact)(double);
+        float (*libm)(float);
+        float (*table)(float);
+        void (*simd)(float*, size_t);
+    };
+
+    static double sineExact(double x) { return std::sin(juce::MathConstants<double>::twoPi * x); }
+    static float sineLibm(float x) { return std::sin(juce::MathConstants<float>::twoPi * x); }
+    static float sineTable(float x) { return WaveshapeTables::getInstance().sineFold(x); }
+
+    static double chebyshevExact(double x) { const double t = std::tanh(x); return 3.0 * t - 4.0 * t * t * t; }
+    static float chebyshevLibm(float x) { return ReferenceShaper::chebyshevPoly(x); }
+    static float chebyshevTable(float x) { return WaveshapeTables::getInstance().chebyshevPoly(x); }
+
+    // Errore massimo e ns per sample di una variante, sulla rampa di ingresso
+    template <typename Function>
+    static void measureTransfer(const juce::String& label, const float* input, float* output, double (*exact)(double),
+                                Function&& function)
+    {
+        const double ns = Benchmark::measureNsPerSample(TABLE_PROBES, [&] { function(input, output); });
+
+        double maxError = 0.0;
+        for (int i = 0; i < TABLE_PROBES; ++i)
+            maxError = juce::jmax(maxError, std::abs(static_cast<double>(output[i]) - exact(static_cast<double>(input[i]))));
+
+        Benchmark::printRow(label, { ns, maxError * 1.0e6 }, 3);
+    }
+
+    /**
+     * [user-003] Lookup table di Hermite contro libm e contro i kernel SIMD
+     * polinomiali del percorso audio, su tutto il range pilotato.
+     * Errore massimo in unità di 1e-6 contro la funzione analitica in double.
+     */
+    static void runTransferTables()
+    {
+        WaveshapeTables::getInstance();
+
+        juce::HeapBlock<char> memory;
+        juce::dsp::AudioBlock<float> block(memory, 2, static_cast<size_t>(TABLE_PROBES));
+        float* input = block.getChannelPointer(0);
+        float* output = block.getChannelPointer(1);
+
+        for (int i = 0; i < TABLE_PROBES; ++i)
+            input[i] = TABLE_RANGE * (2.0f * static_cast<float>(i) / static_cast<float>(TABLE_PROBES - 1) - 1.0f);
+
+        const TransferCase cases[] = {
+            { "sineFold", sineExact, sineLibm, sineTable, WaveshaperCore::shapeSingleSIMD<1> },
+            { "chebyshevPoly", chebyshevExact, chebyshevLibm, chebyshevTable, WaveshaperCore::shapeSingleSIMD<0> }
+        };
+
+        Benchmark::printHeader("[user-003] transfer curves over [-" + juce::String(TABLE_RANGE) + ", "
+                                   + juce::String(TABLE_RANGE) + "], " + juce::String(TABLE_PROBES) + " probes",
+                               "                                ns/sample  max err (1e-6)");
+
+        for (const auto& c : cases)
+        {
+            measureTransfer(juce::String(c.name) + " libm", input, output, c.exact,
+                            [&c](const float* in, float* out)
+                            {
+                                for (int i = 0; i < TABLE_PROBES; ++i)
+                                    out[i] = c.libm(in[i]);
+                            });
+
+            measureTransfer(juce::String(c.name) + " Hermite table", input, output, c.exact,
+                            [&c](const float* in, float* out)
+                            {
+                                for (int i = 0; i < TABLE_PROBES; ++i)
+                                    out[i] = c.table(in[i]);
+                            });
+
+            measureTransfer(juce::String(c.name) + " SIMD polynomial", input, output, c.exact,
+                            [&c](const float* in, float* out)
+                            {
+                                std::copy(in, in + TABLE_PROBES, out);
+                                c.simd(out, static_cast<size_t>(TABLE_PROBES));
+                            });
+        }
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // FOLDBACK (user-005)
+    // ═══════════════════════════════════════════════════════════
+    static constexpr int FOLDBACK_PROBES = 1 << 14;
+    static constexpr float FOLDBACK_RANGE = 24.5f;  // drive 12 con envelope al massimo: ±24
+    static constexpr float FOLDBACK_TOLERANCE = 1.0e-4f;
+
+    template <typename Function>
+    static void measureFoldback(const juce::String& label, float amplitude, Function&& function)
+    {
+        std::vector<float> input(static_cast<size_t>(FOLDBACK_PROBES));
+        Benchmark::fillSignal(input.data(), FOLDBACK_PROBES, amplitude);
+
+        juce::HeapBlock<char> memory;
+        juce::dsp::AudioBlock<float> block(memory, 1, static_cast<size_t>(FOLDBACK_PROBES));
+        float* data = block.getChannelPointer(0);
+
+        Benchmark::printRow(label, { Benchmark::measureNsPerSample(FOLDBACK_PROBES, [&]
+        {
+            std::copy(input.begin(), input.end(), data);
+            function(data, FOLDBACK_PROBES);
+        }, 8) });
+    }
+
+    template <int Factor>
+    static void runFoldbackStage(WaveshaperCore& core, ReferenceShaper& reference,
+                                 const juce::AudioBuffer<float>& source, const float* envData)
+    {
+        juce::AudioBuffer<float> oversampled(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+        const MorphCase foldbackOnly { "foldback", 3.0f, 3.0f };
+
+        const double before = measureReference<Factor>(reference, foldbackOnly, oversampled, source, envData, 12.0, 12.0);
+        const double after = measureCore<Factor>(core, foldbackOnly, 0, oversampled, source, envData, 12.0, 12.0);
+        Benchmark::printRow(juce::String(Factor) + "x foldback, drive 12, env 1", { before, after, before / after });
+    }
+
+    /**
+     * [user-005] Foldback in forma chiusa contro il while originale:
+     * equivalenza su tutto il range pilotato e costo nel caso peggiore
+     * (drive 12 con envelope al massimo: ingresso fino a ±24).
+     */
+    static void runFoldback()
+    {
+        // Equivalenza: rampa densa su [-24.5, 24.5]
+        juce::HeapBlock<char> memory;
+        juce::dsp::AudioBlock<float> block(memory, 1, static_cast<size_t>(FOLDBACK_PROBES));
+        float* simd = block.getChannelPointer(0);
+
+        double maxScalarError = 0.0;
+        double maxSIMDError = 0.0;
+
+        for (int i = 0; i < FOLDBACK_PROBES; ++i)
+            simd[i] = FOLDBACK_RANGE * (2.0f * static_cast<float>(i) / static_cast<float>(FOLDBACK_PROBES - 1) - 1.0f);
+
+        std::vector<float> input(simd, simd + FOLDBACK_PROBES);
+        WaveshaperCore::shapeSingleSIMD<3>(simd, static_cast<size_t>(FOLDBACK_PROBES));
+
+        for (int i = 0; i < FOLDBACK_PROBES; ++i)
+        {
+            const float x = input[static_cast<size_t>(i)];
+            const float expected = ReferenceShaper::foldback(x);
+            maxScalarError = juce::jmax(maxScalarError, static_cast<double>(std::abs(WaveshaperCore::foldback(x) - expected)));
+            maxSIMDError = juce::jmax(maxSIMDError, static_cast<double>(std::abs(simd[i] - expected)));
+        }
+
+        Benchmark::printHeader("[user-005] foldback vs original while loop over [-" + juce::String(FOLDBACK_RANGE) + ", "
+                                   + juce::String(FOLDBACK_RANGE) + "], " + juce::String(FOLDBACK_PROBES) + " probes",
+                               "  max abs difference (1e-6)");
+        Benchmark::printRow("closed form (scalar)", { maxScalarError * 1.0e6 }, 3);
+        Benchmark::printRow("closed form (SIMD)", { maxSIMDError * 1.0e6 }, 3);
+        Benchmark::printNote(juce::String(maxScalarError < FOLDBACK_TOLERANCE && maxSIMDError < FOLDBACK_TOLERANCE ? "OK" : "FAIL")
+                             + ": tolerance " + juce::String(FOLDBACK_TOLERANCE * 1.0e6f, 0) + "e-6"
+                             + " (the while loop accumulates float rounding over its reflections)");
+
+        // Costo per sample, caso peggiore (picco 24) e migliore (picco 0.1)
+        Benchmark::printHeader("[user-005] foldback kernel alone, mono",
+                               "  ns per sample");
+
+        for (const float amplitude : { 24.0f, 0.1f })
+        {
+            const juce::String peak = " (peak " + juce::String(amplitude, 1) + ")";
+
+            measureFoldback("while loop" + peak, amplitude, [](float* data, int n)
+            {
+                for (int i = 0; i < n; ++i)
+                    data[i] = ReferenceShaper::foldback(data[i]);
+            });
+            measureFoldback("closed form" + peak, amplitude, [](float* data, int n)
+            {
+                for (int i = 0; i < n; ++i)
+                    data[i] = WaveshaperCore::foldback(data[i]);
+            });
+            measureFoldback("SIMD" + peak, amplitude, [](float* data, int n)
+            {
+                WaveshaperCore::shapeSingleSIMD<3>(data, static_cast<size_t>(n));
+            });
+        }
+
+        // Stadio completo al massimo di drive ed envelope
+        WaveshaperCore core;
+        core.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE, NUM_CHANNELS);
+
+        ReferenceShaper reference;
+        reference.prepare(SAMPLE_RATE);
+
+        juce::AudioBuffer<float> source(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+        Benchmark::fillSignal(source, 1.0f);
+        std::vector<float> envelope(static_cast<size_t>(BLOCK_SIZE), 1.0f);
+
+        Benchmark::printHeader("[user-005] oversampled shaping stage at maximum drive and envelope, stereo",
+                               "  ns per native sample            reference   current   speedup");
+
+        runFoldbackStage<1>(core, reference, source, envelope.data());
+        runFoldbackStage<4>(core, reference, source, envelope.data());
+        runFoldbackStage<16>(core, reference, source, envelope.data());
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // ADAA (user-004)
+    // ═══════════════════════════════════════════════════════════
+
+    // ADAA di primo ordine originale (scalare, double, differenza delle
+    // antiderivate con fallback al punto medio): riferimento di accuratezza
+    struct ReferenceADAA
+    {
+        static double triangleU(double x)
+        {
+            const double phase = x + 0.25;
+            return phase - std::floor(phase + 0.5);
+        }
+
+        static double foldbackW(double x)
+        {
+            const double v = 2.0 * x + 0.25;
+            return 4.0 * (v - std::floor(v)) - 2.0;
+        }
+
+        static double logCosh(double x)
+        {
+            x = std::abs(x);
+            return x + std::log1p(std::exp(-2.0 * x)) - 0.69314718055994530942;
+        }
+
+        static double shapeF0(int shape, double x)
+        {
+            switch (shape)
+            {
+                case 0:  { const double t = std::tanh(x); return 3.0 * t - 4.0 * t * t * t; }
+                case 1:  return std::sin(juce::MathConstants<double>::twoPi * x);
+                case 2:  return 4.0 * std::abs(triangleU(x)) - 1.0;
+                default: return 1.0 - std::abs(foldbackW(x));
+            }
+        }
+
+        static double shapeF1(int shape, double x)
+        {
+            switch (shape)
+            {
+                case 0:  { const double t = std::tanh(x); return 2.0 * t * t - logCosh(x); }
+                case 1:  return -std::cos(juce::MathConstants<double>::twoPi * x) / juce::MathConstants<double>::twoPi;
+                case 2:  { const double u = triangleU(x); return 2.0 * u * std::abs(u) - u; }
+                default: { const double w = foldbackW(x); return 0.125 * (w - 0.5 * w * std::abs(w)); }
+            }
+        }
+
+        void process(float* data, const float* morph, size_t numSamples)
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const double x = data[i];
+                const int segment = juce::jlimit(0, 2, static_cast<int>(morph[i]));
+                const double blend = morph[i] - static_cast<float>(segment);
+
+                double y = 0.0;
+                if (blend < 1.0)
+                    y += (1.0 - blend) * processShape(segment, x);
+                if (blend > 0.0)
+                    y += blend * processShape(segment + 1, x);
+
+                x1 = x;
+                data[i] = static_cast<float>(y);
+            }
+        }
+
+        double processShape(int shape, double x) const
+        {
+            const double diff = x - x1;
+            return std::abs(diff) < 1.0e-5 ? shapeF0(shape, 0.5 * (x + x1))
+                                           : (shapeF1(shape, x) - shapeF1(shape, x1)) / diff;
+        }
+
+        double x1 = 0.0;
+    };
+
+    static constexpr float SHAPE_MORPHS[] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    static constexpr const char* SHAPE_NAMES[] = { "chebyshev", "sineFold", "triangle", "foldback" };
+
+    // Errore massimo dell'ADAA1 SIMD contro il riferimento double, sul
+    // segnale di prova "driven" (±24) a ogni fattore: dx piccoli ad alti
+    // fattori, grandi a 1x
+    static void runAntiAliasingAccuracy(const juce::AudioBuffer<float>& source)
+    {
+        constexpr int numSamples = BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR;
+
+        juce::HeapBlock<char> memory;
+        juce::dsp::AudioBlock<float> block(memory, 4, static_cast<size_t>(numSamples));
+        float* simdData = block.getChannelPointer(0);
+        float* morph = block.getChannelPointer(1);
+        float* scratch = block.getChannelPointer(2);
+        std::vector<float> referenceData(static_cast<size_t>(numSamples));
+
+        Benchmark::printHeader("[user-004] ADAA1 SIMD (float) vs original double ADAA1, driven test signal (peak 24)",
+                               "  max abs error (1e-6)               1x        4x       16x");
+
+        auto measure = [&](const juce::String& label, auto&& fillMorph)
+        {
+            std::vector<double> errors;
+
+            for (const int factor : { 1, 4, 16 })
+            {
+                // Sinusoidi più lente a fattori alti, come dopo l'upsampling
+                for (int i = 0; i < numSamples; ++i)
+                    simdData[i] = 24.0f * source.getSample(0, i / factor);
+
+                fillMorph(morph, numSamples);
+                std::copy(simdData, simdData + numSamples, referenceData.begin());
+
+                ADAAShaper shaper;
+                ReferenceADAA reference;
+                shaper.process(simdData, morph, scratch, static_cast<size_t>(numSamples), 1);
+                reference.process(referenceData.data(), morph, static_cast<size_t>(numSamples));
+
+                double maxError = 0.0;
+                for (int i = 0; i < numSamples; ++i)
+                    maxError = juce::jmax(maxError, static_cast<double>(std::abs(simdData[i] - referenceData[static_cast<size_t>(i)])));
+
+                errors.push_back(maxError * 1.0e6);
+            }
+
+            Benchmark::printRow(label, { errors[0], errors[1], errors[2] }, 3);
+        };
+
+        for (int shape = 0; shape < 4; ++shape)
+            measure(SHAPE_NAMES[shape], [shape](float* morph, int n) { std::fill(morph, morph + n, SHAPE_MORPHS[shape]); });
+
+        measure("morph ramp 0-3", [](float* morph, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                morph[i] = 3.0f * static_cast<float>(i) / static_cast<float>(n - 1);
+        });
+
+        // Solo il kernel ADAA1, per sample sovracampionato mono
+        Benchmark::printHeader("[user-004] ADAA1 kernel alone, mono",
+                               "  ns per oversampled sample      double ref      SIMD   speedup");
+
+        for (int i = 0; i < numSamples; ++i)
+            referenceData[static_cast<size_t>(i)] = 24.0f * source.getSample(0, i / 4);
+
+        for (int shape = 0; shape < 4; ++shape)
+        {
+            std::fill(morph, morph + numSamples, SHAPE_MORPHS[shape]);
+
+            ADAAShaper shaper;
+            ReferenceADAA reference;
+
+            const double before = Benchmark::measureNsPerSample(numSamples, [&]
+            {
+                std::copy(referenceData.begin(), referenceData.end(), simdData);
+                reference.process(simdData, morph, static_cast<size_t>(numSamples));
+            }, 8);
+
+            const double after = Benchmark::measureNsPerSample(numSamples, [&]
+            {
+                std::copy(referenceData.begin(), referenceData.end(), simdData);
+                shaper.process(simdData, morph, scratch, static_cast<size_t>(numSamples), 1);
+            }, 8);
+
+            Benchmark::printRow(SHAPE_NAMES[shape], { before, after, before / after });
+        }
+    }
+
+    template <int Factor>
+    static void runAntiAliasingFactor(WaveshaperCore& core, const juce::AudioBuffer<float>& source, const float* envData)
+    {
+        juce::AudioBuffer<float> oversampled(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+
+        for (int shape = 0; shape < 4; ++shape)
+        {
+            const MorphCase morph { SHAPE_NAMES[shape], SHAPE_MORPHS[shape], SHAPE_MORPHS[shape] };
+            double costs[3];
+
+            for (int order = 0; order < 3; ++order)
+            {
+                for (auto& shaper : core.adaaShapers)
+                    shaper.reset();
+
+                costs[order] = measureCore<Factor>(core, morph, order, oversampled, source, envData);
+            }
+
+            Benchmark::printRow(juce::String(Factor) + "x " + SHAPE_NAMES[shape], { costs[0], costs[1], costs[2] });
+        }
+    }
+
+    /**
+     * [user-004] Accuratezza dell'ADAA1 vettoriale e costo dello stadio
+     * sovracampionato (rampe + shaping) per forma, fattore e ordine ADAA.
+     */
+    static void runAntiAliasing()
+    {
+        WaveshaperCore core;
+        core.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE, NUM_CHANNELS);
+
+        juce::AudioBuffer<float> source(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+        Benchmark::fillSignal(source, 1.0f);
+
+        std::vector<float> envelope(static_cast<size_t>(BLOCK_SIZE), 0.5f);
+
+        runAntiAliasingAccuracy(source);
+
+        Benchmark::printHeader("[user-004] oversampled shaping stage by ADAA order, stereo, " + juce::String(BLOCK_SIZE) + "-sample blocks",
+                               "  ns per native sample                  off      ADAA1     ADAA2");
+
+        runAntiAliasingFactor<1>(core, source, envelope.data());
+        runAntiAliasingFactor<2>(core, source, envelope.data());
+        runAntiAliasingFactor<4>(core, source, envelope.data());
+        runAntiAliasingFactor<8>(core, source, envelope.data());
+        runAntiAliasingFactor<16>(core, source, envelope.data());
+    }
+
+    /**
+     * [user-001] Kernel SIMD dello shaping contro il loop scalare originale.
+     * ns per sample nativo stereo (il costo cresce con il fattore).
+     */
+    static void runShapingKernel()
+    {
+        WaveshaperCore core;
+        core.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE, NUM_CHANNELS);
+
+        ReferenceShaper reference;
+        reference.prepare(SAMPLE_RATE);
+
+        // Ingresso già "sovracampionato" per il fattore massimo, envelope 0-1
+        juce::AudioBuffer<float> source(NUM_CHANNELS, BLOCK_SIZE * WaveshaperCore::MAX_OVERSAMPLING_FACTOR);
+        Benchmark::fillSignal(source, 1.0f);
+
+        std::vector<float> envelope(static_cast<size_t>(BLOCK_SIZE));
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+            envelope[static_cast<size_t>(i)] = 0.5f + 0.5f * std::sin(0.01f * static_cast<float>(i));
+
+        Benchmark::printHeader("[user-001] oversampled shaping stage, stereo, " + juce::String(BLOCK_SIZE) + "-sample blocks",
+                               "  ns per native sample            reference   current   speedup");
+
+        runShapingFactor<1>(core, reference, source, envelope.data());
+        runShapingFactor<2>(core, reference, source, envelope.data());
+        runShapingFactor<4>(core, reference, source, envelope.data());
+        runShapingFactor<8>(core, reference, source, envelope.data());
+        runShapingFactor<16>(core, reference, source, envelope.data());
+    }
+};
@@ -4,8 +4,7 @@
 
 //==============================================================================
 
-class AbstractProcessor : public virtual juce::AudioProcessor,
-    public virtual juce::AudioProcessorValueTreeState::Listener
+class AbstractProcessor : public virtual juce::AudioProcessor
 {
 public:
     //==============================================================================
@@ -119,7 +118,8 @@ template processor.h
 //==============================================================================
 
 
-class DelayAudioProcessor : public AbstractProcessor
+class DelayAudioProcessor : public AbstractProcessor,
+    private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     //==============================================================================
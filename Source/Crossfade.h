@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * CROSSFADE
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Crossfade lineare tra due percorsi di segnale (uscente -> entrante) su una
+ * durata fissa, anche a cavallo di più blocchi.
+ *
+ * Usato per i cambi strutturali a confine di blocco (configurazione di
+ * oversampling, tap del dry delay, modalità del disperser): il chiamante
+ * elabora entrambi i percorsi in buffer preallocati finché isActive() e
+ * process() mescola il risultato nel buffer entrante.
+ */
+class Crossfade
+{
+public:
+    explicit Crossfade(int lengthInSamples)
+        : length(lengthInSamples)
+    {
+        jassert(lengthInSamples > 0);
+    }
+
+    void start() noexcept { remaining = length; }
+    void reset() noexcept { remaining = 0; }
+    bool isActive() const noexcept { return remaining > 0; }
+
+    /**
+     * incoming = outgoing + g * (incoming - outgoing), g da 0 a 1 lungo il
+     * crossfade; oltre la fine resta il solo percorso entrante
+     */
+    void process(float* const* incoming, const float* const* outgoing, int numChannels, int numSamples) noexcept
+    {
+        const int fadeLength = juce::jmin(numSamples, remaining);
+        const float step = 1.0f / static_cast<float>(length);
+        const float startGain = static_cast<float>(length - remaining) * step;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* in = incoming[ch];
+            const float* out = outgoing[ch];
+
+            for (int i = 0; i < fadeLength; ++i)
+                in[i] = out[i] + (startGain + static_cast<float>(i) * step) * (in[i] - out[i]);
+        }
+
+        remaining -= fadeLength;
+    }
+
+private:
+    const int length;
+    int remaining = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(Crossfade)
+};
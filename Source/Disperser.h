@@ -1,79 +1,237 @@
+#pragma once
 
 /**
  * ═══════════════════════════════════════════════════════════════════════════
  * DISPERSER MODULE
  * ═══════════════════════════════════════════════════════════════════════════
  *
- * Implementa una cascata di 16 filtri allpass per creare dispersione di fase
- * (group delay) senza alterare la risposta in ampiezza.
+ * Implementa una cascata di filtri allpass (4-128 stadi, default 16) per creare
+ * dispersione di fase (group delay) senza alterare la risposta in ampiezza.
  *
  * ARCHITETTURA:
- * - 16 stadi di filtri allpass in serie per canale
+ * - N stadi di filtri allpass in serie per canale, banco preallocato per
+ *   MAX_STAGES: cambiare il numero di stadi non alloca
+ * - Gli stadi aggiunti entrano da passthrough, quelli rimossi sfumano verso
+ *   passthrough: ogni stadio ha un peso (0 = passthrough, 1 = allpass)
  * - Distribuzione logaritmica delle frequenze lungo lo spettro
- * - Coefficient interpolation per eliminare zipper noise
+ * - Cascata SoA condivisa da tutti i canali (AllpassCascade), un canale
+ *   per lane
+ *
+ * MODULAZIONE:
+ * - I coefficienti di tutti gli stadi sono ricalcolati ogni CONTROL_RATE
+ *   sample (8) da un kernel vettoriale: moltiplicatori di frequenza e 1/2Q
+ *   precalcolati per stadio, sin/cos dell'angolo con polinomi, nessuna
+ *   funzione trascendente per stadio
+ * - La frequenza base è smussata (moltiplicativa) e modulabile dall'envelope
+ *   (Env Mod, ±MOD_OCTAVES ottave per unità di envelope)
+ * - Amount, Pinch e Stages cambiano la disposizione degli stadi con una
+ *   rampa lineare di LAYOUT_RAMP_SAMPLES
+ * - Parametri fermi: i coefficienti restano quelli dell'ultimo blocco e la
+ *   cascata gira senza ricalcoli
+ *
+ * MODALITÀ CONVOLUTION:
+ * - La risposta all'impulso della stessa cascata viene calcolata su un thread
+ *   in background (IRDesigner) e applicata con juce::dsp::Convolution a
+ *   partizioni uniformi, latenza fissa CONVOLUTION_LATENCY. Convolution è
+ *   al più stereo: un'istanza per coppia di canali, con la stessa IR e una
+ *   coda di messaggi condivisa (un solo thread di caricamento)
+ * - Il costo non dipende dal numero di stadi né dal Q: utile per dispersioni
+ *   estreme, dove la cascata IIR diventa costosa e delicata numericamente
+ * - Ogni nuova IR viene sostituita con il crossfade interno di Convolution
+ * - La latenza è riportata da getLatencySamples (solo in questa modalità)
+ * - Il cambio di modalità avviene a confine di blocco (updateConfiguration),
+ *   con un crossfade tra i due motori. Convolution carica la IR in modo
+ *   asincrono: consegnata la IR richiesta dopo il cambio, i motori girano
+ *   in ombra su una copia dell'ingresso finché l'hanno installata e hanno
+ *   elaborato latenza più lunghezza della IR (storia piena), poi entrano
+ * - Al più un design ogni MIN_DESIGN_INTERVAL_MS: le richieste arrivate nel
+ *   frattempo si fondono in un solo design con i valori più recenti
  *
  * PARAMETRI:
  * - Amount [0-1]: Intensità dell'effetto (controlla il Q dei filtri)
  * - Frequency [20-20k Hz]: Frequenza centrale della dispersione
  * - Pinch [0.1-10]: Concentrazione dei filtri (alto=picco stretto, basso=wide)
+ * - Stages [4-128]: Numero di stadi (più stadi = più dispersione, costo lineare)
+ * - Mode: Cascade (IIR, latenza zero) o Convolution (IR, latenza fissa)
+ * - Env Mod [-1, 1]: Modulazione della frequenza dall'envelope (solo Cascade)
  *
  * OTTIMIZZAZIONI:
- * - Bypass automatico quando amount < 0.005
- * - Calcolo coefficienti solo su cambiamenti significativi dei parametri
+ * - Bypass automatico quando amount < 0.005 (solo Cascade: in Convolution la
+ *   latenza deve restare costante, l'IR diventa un impulso unitario)
+ * - Calcolo coefficienti solo mentre qualcosa si muove
+ * - I setter segnano solo le modifiche: un ricalcolo per blocco al massimo
  */
 #include "Filters.h"
+#include "Crossfade.h"
 
 class Disperser
 {
 public:
-    static constexpr int MAX_STAGES = 16;
+    static constexpr int MAX_STAGES = Parameters::maxDisperserStages;
+    static constexpr int MAX_CHANNELS = Parameters::maxChannels;
+    static constexpr int CONVOLUTION_LATENCY = 512;     // Dimensione partizione (sample)
+    static constexpr int MAX_IR_LENGTH = 1 << 16;       // ~1.4s @ 48kHz
+    static constexpr int CONTROL_RATE = AllpassCascade<MAX_STAGES>::CONTROL_RATE;
+    static constexpr int LAYOUT_RAMP_SAMPLES = 64;      // Rampa di amount/pinch/stages
+    static constexpr float MOD_OCTAVES = 2.0f;          // Ottave per unità di envelope
+
+    enum class Mode
+    {
+        Cascade = 0,
+        Convolution
+    };
 
     Disperser(float defaultAmount = 0.0f, float defaultFrequency = 1000.0f, float defaultPinch = 1.0f)
         : currentAmount(defaultAmount)
         , currentFrequency(defaultFrequency)
         , currentPinch(defaultPinch)
+        , designer(convolutions)
     {
+        frequency.setCurrentAndTargetValue(defaultFrequency);
     }
 
-    void prepareToPlay(double sampleRate, int samplesPerBlock)
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels)
     {
         this->sampleRate = sampleRate;
+        numChannels = juce::jlimit(1, MAX_CHANNELS, numChannels);
+
+        // Prepara la cascata (buffer di lavoro per il blocco massimo)
+        cascade.prepare(samplesPerBlock, numChannels);
+        processedStages = numStages;
+
+        frequency.reset(sampleRate, 0.02);
+        frequency.setCurrentAndTargetValue(currentFrequency);
+
+        // Motori a convoluzione, uno per coppia di canali del layout: creati
+        // qui (fuori dall'audio thread) con il designer fermo, che li usa.
+        // IR calcolata in background
+        designer.stop();
+        numConvolutions = (numChannels + 1) / 2;
+        while (convolutions.size() < numConvolutions)
+            convolutions.add(new juce::dsp::Convolution(juce::dsp::Convolution::Latency{ CONVOLUTION_LATENCY }, convolutionQueue));
+        convolutions.removeLast(convolutions.size() - numConvolutions);
+
+        juce::dsp::ProcessSpec spec;
+        spec.sampleRate = sampleRate;
+        spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
+        spec.numChannels = 2;
+        for (auto* convolution : convolutions)
+            convolution->prepare(spec);
+        designer.prepare(sampleRate, numConvolutions);
+
+        activeMode = requestedMode.load();
+        modeFade.reset();
+        convolutionWarmup = false;
+        fadeBuffer.setSize(numChannels, samplesPerBlock);
+        fadeBuffer.clear();
+
+        // Disposizione degli stadi già a regime, coefficienti iniziali
+        designLayout(layoutTarget, numStages, currentAmount, currentPinch);
+        layout = layoutTarget;
+        layoutRampBlocks = 0;
+        layoutPending = false;
+
+        Coefficients initial;
+        computeRow(initial, layout, MAX_STAGES, currentFrequency, sampleRate);
+        cascade.setCoefficients(initial);
+
+        if (activeMode == Mode::Convolution)
+            requestDesign();
+
+        tailPending = true;
+    }
+
+    /**
+     * Applica il cambio di modalità richiesto a confine di blocco, prima di
+     * getLatencySamples. La convoluzione entra dopo il riscaldamento in
+     * ombra (IR richiesta dopo il cambio consegnata e installata in ogni
+     * motore, storia piena); le IR successive entrano con il crossfade
+     * interno di Convolution. Il passaggio è un crossfade di
+     * CROSSFADE_SAMPLES tra i due motori.
+     */
+    void updateConfiguration()
+    {
+        const auto mode = requestedMode.load();
+        if (mode == activeMode || modeFade.isActive())
+        {
+            convolutionWarmup = false;
+            return;
+        }
 
-        // Prepara tutti i filtri
-        for (int ch = 0; ch < 2; ++ch)
+        if (mode == Mode::Convolution)
         {
-            for (auto& filter : filters[ch])
+            if (!designer.isDesignDelivered(convolutionDesign))
+                return;
+
+            // I motori ripartono da stato pulito e scaldano in processBlock
+            if (!convolutionWarmup)
             {
-                filter.prepare(sampleRate);
+                for (int pair = 0; pair < numConvolutions; ++pair)
+                    convolutions[pair]->reset();
+
+                convolutionWarmup = true;
+                warmupSamples = 0;
+                return;
             }
+
+            if (!isConvolutionWarm())
+                return;
+
+            convolutionWarmup = false;
+        }
+        else
+        {
+            // La cascata che rientra riparte da stato pulito
+            cascade.clearState();
         }
 
-        // Inizializza i coefficienti con i valori di default
-        updateCoefficients(currentAmount, currentFrequency, currentPinch);
+        fadeFromMode = activeMode;
+        activeMode = mode;
+        modeFade.start();
     }
 
-    void processBlock(juce::AudioBuffer<float>& buffer)
+    void processBlock(juce::AudioBuffer<float>& buffer, const juce::AudioBuffer<float>& envelopeBuffer)
     {
         const int numSamples = buffer.getNumSamples();
-        const int numChannels = buffer.getNumChannels();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), fadeBuffer.getNumChannels());
 
-        // Bypass ottimizzato se amount è quasi zero
-        if (currentAmount < 0.005f)
+        // Amount, pinch e stages cambiati dall'ultimo blocco: un solo ricalcolo
+        if (layoutPending)
         {
-            return;
+            layoutPending = false;
+            updateLayout();
         }
 
-        // Processing stereo
-        for (int ch = 0; ch < numChannels && ch < 2; ++ch)
+        // Riscaldamento di Convolution: elabora una copia dell'ingresso, scartata
+        if (convolutionWarmup)
         {
-            float* channelData = buffer.getWritePointer(ch);
+            juce::AudioBuffer<float> shadow(fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+            for (int ch = 0; ch < numChannels; ++ch)
+                shadow.copyFrom(ch, 0, buffer, ch, 0, numSamples);
 
-            // Applica tutti i 16 stadi in cascata
-            for (int stage = 0; stage < MAX_STAGES; ++stage)
-            {
-                filters[ch][stage].processBlock(channelData, numSamples);
-            }
+            processEngine(Mode::Convolution, shadow, envelopeBuffer);
+            warmupSamples = juce::jmin(warmupSamples + numSamples, convolutions.getFirst()->getLatency() + MAX_IR_LENGTH);
+        }
+
+        // Crossfade di modalità: il motore uscente elabora una copia dell'ingresso
+        const bool fading = modeFade.isActive();
+        if (fading)
+        {
+            juce::AudioBuffer<float> outgoing(fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+            for (int ch = 0; ch < numChannels; ++ch)
+                outgoing.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+
+            processEngine(fadeFromMode, outgoing, envelopeBuffer);
         }
+
+        processEngine(activeMode, buffer, envelopeBuffer);
+
+        if (fading)
+            modeFade.process(buffer.getArrayOfWritePointers(), fadeBuffer.getArrayOfReadPointers(), numChannels, numSamples);
+
+        // Lo smoothing della frequenza avanza comunque se la cascata non ha girato
+        if (activeMode == Mode::Convolution && !(fading && fadeFromMode == Mode::Cascade))
+            frequency.skip(numSamples);
     }
 
     void setAmount(float newAmount)
@@ -82,17 +240,22 @@ public:
         if (std::abs(newAmount - currentAmount) > 0.001f)
         {
             currentAmount = newAmount;
-            updateCoefficients(currentAmount, currentFrequency, currentPinch);
+            layoutPending = true;
+            tailPending = true;
         }
     }
 
     void setFrequency(float newFrequency)
     {
         newFrequency = juce::jlimit(20.0f, 20000.0f, newFrequency);
-        if (std::abs(newFrequency - currentFrequency) > 5.0f)
+        if (newFrequency != currentFrequency)
         {
             currentFrequency = newFrequency;
-            updateCoefficients(currentAmount, currentFrequency, currentPinch);
+            frequency.setTargetValue(newFrequency);
+            tailPending = true;
+
+            if (requestedMode.load() == Mode::Convolution)
+                requestDesign();
         }
     }
 
@@ -102,24 +265,299 @@ public:
         if (std::abs(newPinch - currentPinch) > 0.01f)
         {
             currentPinch = newPinch;
-            updateCoefficients(currentAmount, currentFrequency, currentPinch);
+            layoutPending = true;
+            tailPending = true;
+        }
+    }
+
+    void setNumStages(int newNumStages)
+    {
+        newNumStages = juce::jlimit(Parameters::minDisperserStages, MAX_STAGES, newNumStages);
+        if (newNumStages != numStages)
+        {
+            numStages = newNumStages;
+            layoutPending = true;
+            tailPending = true;
         }
     }
 
+    int getNumStages() const
+    {
+        return numStages;
+    }
+
+    void setEnvModAmount(float newAmount)
+    {
+        newAmount = juce::jlimit(-1.0f, 1.0f, newAmount);
+        if (newAmount != envModAmount)
+        {
+            envModAmount = newAmount;
+            tailPending = true;
+        }
+    }
+
+    void setMode(int newMode)
+    {
+        const auto mode = newMode == 1 ? Mode::Convolution : Mode::Cascade;
+        if (requestedMode.exchange(mode) != mode && mode == Mode::Convolution)
+            convolutionDesign = requestDesign();
+    }
+
+    /**
+     * Un solo canale basta se i canali sono identici: la cascata ha lo stato
+     * per lane (ricopiabile con copyChannelState), la convoluzione no, quindi
+     * con il motore a convoluzione in gioco (anche in riscaldamento) servono
+     * tutti i canali
+     */
+    bool canProcessMono() const
+    {
+        return activeMode == Mode::Cascade && !modeFade.isActive() && !convolutionWarmup;
+    }
+
+    void copyChannelState(int sourceChannel, int destinationChannel)
+    {
+        cascade.copyLaneState(sourceChannel, destinationChannel);
+    }
+
+    // Modalità Multithread: gruppi di lane della cascata e coppie di canali
+    // della convoluzione sul pool
+    void setWorkerPool(WorkerPool* pool) noexcept
+    {
+        workerPool = pool;
+    }
+
+    // La cascata passa a lavorare in M/S (o torna in L/R) senza discontinuità
+    void convertChannelState(bool toMidSide)
+    {
+        cascade.convertMidSideState(toMidSide);
+    }
+
+    // Latenza della modalità più lenta (per la modalità a latenza costante)
+    static int getMaxLatencySamples()
+    {
+        return CONVOLUTION_LATENCY;
+    }
+
     int getLatencySamples() const
     {
-        return 0; // IIR filters have group delay but no fixed latency
+        // IIR filters have group delay but no fixed latency
+        return activeMode == Mode::Convolution ? convolutions.getFirst()->getLatency() : 0;
+    }
+
+    /**
+     * Coda a ingresso fermo oltre la latenza. Convolution: l'IR, al più
+     * MAX_IR_LENGTH. Cascade: somma dei group delay degli stadi più il
+     * decadimento dello stadio più lento, con lo stesso limite (le IR sono
+     * tagliate lì). Ricalcolata solo quando cambia un parametro.
+     */
+    int getTailSamples()
+    {
+        if (activeMode == Mode::Convolution || modeFade.isActive())
+            return MAX_IR_LENGTH;
+
+        if (tailPending)
+        {
+            tailPending = false;
+            cascadeTailSamples = computeCascadeTailSamples();
+        }
+
+        return cascadeTailSamples;
     }
 
 private:
+    using Coefficients = AllpassCascade<MAX_STAGES>::Coefficients;
+
+    static constexpr int LAYOUT_RAMP_BLOCKS = LAYOUT_RAMP_SAMPLES / CONTROL_RATE;
+    static constexpr int CROSSFADE_SAMPLES = 512;       // Cambio di modalità (~10ms @ 48kHz)
+
+    // Ogni motore ha installato l'ultima IR consegnata e ne ha la storia piena
+    bool isConvolutionWarm() const
+    {
+        const int irLength = designer.getDeliveredLength();
+        if (warmupSamples < convolutions.getFirst()->getLatency() + irLength)
+            return false;
+
+        for (int pair = 0; pair < numConvolutions; ++pair)
+            if (convolutions[pair]->getCurrentIRSize() != irLength)
+                return false;
+
+        return true;
+    }
+
+    void processEngine(Mode mode, juce::AudioBuffer<float>& buffer, const juce::AudioBuffer<float>& envelopeBuffer)
+    {
+        if (mode == Mode::Convolution)
+        {
+            juce::dsp::AudioBlock<float> block(buffer);
+            const int numChannels = juce::jmin(buffer.getNumChannels(), 2 * numConvolutions);
+
+            auto processPair = [&](int pair)
+            {
+                const int first = pair * 2;
+                auto pairBlock = block.getSubsetChannelBlock(static_cast<size_t>(first),
+                                                             static_cast<size_t>(juce::jmin(2, numChannels - first)));
+                convolutions[pair]->process(juce::dsp::ProcessContextReplacing<float>(pairBlock));
+            };
+
+            const int numPairs = (numChannels + 1) / 2;
+            if (workerPool != nullptr)
+                workerPool->parallelFor(numPairs, processPair);
+            else
+                for (int pair = 0; pair < numPairs; ++pair)
+                    processPair(pair);
+        }
+        else
+        {
+            processCascade(buffer, envelopeBuffer);
+        }
+    }
+
+    void processCascade(juce::AudioBuffer<float>& buffer, const juce::AudioBuffer<float>& envelopeBuffer)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = buffer.getNumChannels();
+
+        // Bypass ottimizzato se amount è quasi zero (a rampa conclusa)
+        if (currentAmount < 0.005f && layoutRampBlocks == 0)
+        {
+            frequency.skip(numSamples);
+            return;
+        }
+
+        float* const* channels = buffer.getArrayOfWritePointers();
+        const int numLanes = juce::jmin(numChannels, MAX_CHANNELS);
+
+        // Niente in movimento: coefficienti dell'ultimo blocco, nessun ricalcolo
+        if (!frequency.isSmoothing() && layoutRampBlocks == 0 && envModAmount == 0.0f)
+        {
+            cascade.process(channels, numLanes, numSamples, processedStages, workerPool);
+            return;
+        }
+
+        // Processing modulato: una riga di coefficienti ogni CONTROL_RATE sample
+        jassert(numSamples <= envelopeBuffer.getNumSamples());
+        const float* envelope = envelopeBuffer.getReadPointer(0);
+        const float modOctaves = envModAmount * MOD_OCTAVES;
+
+        cascade.processModulated(channels, numLanes, numSamples, processedStages,
+                                 [&](int controlBlock, Coefficients& row)
+                                 {
+                                     const int offset = controlBlock * CONTROL_RATE;
+                                     double baseFrequency = frequency.getCurrentValue();
+                                     frequency.skip(juce::jmin(CONTROL_RATE, numSamples - offset));
+
+                                     if (modOctaves != 0.0f)
+                                         baseFrequency *= std::exp2(modOctaves * envelope[offset]);
+
+                                     if (layoutRampBlocks > 0)
+                                         advanceLayout();
+
+                                     computeRow(row, layout, processedStages, baseFrequency, sampleRate);
+                                 },
+                                 workerPool);
+
+        // A fine rampa gli stadi rimossi sono passthrough: si possono saltare
+        if (layoutRampBlocks == 0)
+            processedStages = numStages;
+    }
+
     /**
-     * Ricalcola e aggiorna i coefficienti di tutti i filtri della cascata
+     * Disposizione degli stadi (SoA): moltiplicatore della frequenza base,
+     * 1/(2Q) e peso (0 = passthrough, 1 = allpass pieno)
      */
-    void updateCoefficients(float amount, float freq, float pinch)
+    struct StageLayout
     {
-        float nyquist = static_cast<float>(sampleRate * 0.49);
-        float safeFreq = juce::jlimit(20.0f, nyquist, freq);
+        std::array<double, MAX_STAGES> multiplier {}, invTwoQ {}, weight {};
+    };
 
+    /**
+     * Nuovo target di disposizione: rampa lineare dalla posizione corrente
+     */
+    void updateLayout()
+    {
+        designLayout(layoutTarget, numStages, currentAmount, currentPinch);
+
+        // Gli stadi che rientrano partono da passthrough con stato pulito
+        for (int i = processedStages; i < numStages; ++i)
+        {
+            cascade.clearStage(i);
+            layout.multiplier[i] = layoutTarget.multiplier[i];
+            layout.invTwoQ[i] = layoutTarget.invTwoQ[i];
+            layout.weight[i] = 0.0;
+        }
+
+        // Stadi rimossi: sfumano verso passthrough, processati fino a fine rampa
+        processedStages = juce::jmax(processedStages, numStages);
+
+        constexpr double rampScale = 1.0 / LAYOUT_RAMP_BLOCKS;
+        for (int i = 0; i < processedStages; ++i)
+        {
+            layoutStep.multiplier[i] = (layoutTarget.multiplier[i] - layout.multiplier[i]) * rampScale;
+            layoutStep.invTwoQ[i] = (layoutTarget.invTwoQ[i] - layout.invTwoQ[i]) * rampScale;
+            layoutStep.weight[i] = (layoutTarget.weight[i] - layout.weight[i]) * rampScale;
+        }
+
+        layoutRampBlocks = LAYOUT_RAMP_BLOCKS;
+
+        if (requestedMode.load() == Mode::Convolution)
+            requestDesign();
+    }
+
+    // Un passo di rampa per blocco di controllo (l'ultimo arriva esatto al target)
+    void advanceLayout()
+    {
+        if (--layoutRampBlocks == 0)
+        {
+            layout = layoutTarget;
+            return;
+        }
+
+        for (int i = 0; i < processedStages; ++i)
+        {
+            layout.multiplier[i] += layoutStep.multiplier[i];
+            layout.invTwoQ[i] += layoutStep.invTwoQ[i];
+            layout.weight[i] += layoutStep.weight[i];
+        }
+    }
+
+    int computeCascadeTailSamples() const
+    {
+        if (currentAmount < 0.005f)
+            return 0;
+
+        // Frequenza più bassa raggiungibile con Env Mod negativo (envelope 1)
+        const double lowestBase = currentFrequency * std::exp2(juce::jmin(0.0f, envModAmount) * MOD_OCTAVES);
+
+        StageLayout stages;
+        designLayout(stages, numStages, currentAmount, currentPinch);
+
+        double groupDelay = 0.0, slowestTimeConstant = 0.0;
+        for (int i = 0; i < numStages; ++i)
+        {
+            if (stages.weight[i] == 0.0)
+                continue;
+
+            const double stageFreq = juce::jlimit(20.0, sampleRate * 0.49, lowestBase * stages.multiplier[i]);
+            const double timeConstant = Tail::getTimeConstantSamples(stageFreq, stages.invTwoQ[i], sampleRate);
+            groupDelay += 2.0 * timeConstant;
+            slowestTimeConstant = juce::jmax(slowestTimeConstant, timeConstant);
+        }
+
+        const double tail = groupDelay + Tail::TIME_CONSTANTS_TO_SILENCE * slowestTimeConstant;
+        return static_cast<int>(std::ceil(juce::jmin(tail, static_cast<double>(MAX_IR_LENGTH))));
+    }
+
+    int requestDesign()
+    {
+        return designer.requestDesign(currentAmount, currentFrequency, currentPinch, numStages);
+    }
+
+    /**
+     * Distribuzione di frequenze e Q degli stadi: condivisa dalla cascata
+     * real-time e dal designer dell'IR
+     */
+    static void designLayout(StageLayout& target, int numStages, float amount, float pinch)
+    {
         // Mapping amount con curva quadratica (risposta naturale)
         float amountCurved = amount * amount;
 
@@ -128,36 +566,304 @@ private:
         double maxQ = 0.5 + (pinch * 0.5);
         double baseQ = minQ + amountCurved * (maxQ - minQ);
 
-        // Distribuzione dei 16 filtri lungo lo spettro
-        for (int i = 0; i < MAX_STAGES; ++i)
+        // Spread logaritmico (in ottave), progressione geometrica lungo gli stadi
+        // Pinch alto = filtri concentrati, Pinch basso = filtri distribuiti
+        const double octaveSpread = 3.0 / pinch;
+        const double ratioStep = numStages > 1 ? 1.0 / (numStages - 1) : 0.0;
+        const double multiplierStep = std::exp2(octaveSpread * ratioStep);
+        double multiplier = numStages > 1 ? std::exp2(-0.5 * octaveSpread) : 1.0;
+
+        // Distribuzione degli N filtri lungo lo spettro
+        for (int i = 0; i < numStages; ++i)
         {
             // Ratio normalizzato da 0.0 (primo filtro) a 1.0 (ultimo filtro)
-            float ratio = (MAX_STAGES > 1) ? (float)i / (MAX_STAGES - 1) : 0.5f;
-
-            // Spread logaritmico (in ottave)
-            // Pinch alto = filtri concentrati, Pinch basso = filtri distribuiti
-            float octaveSpread = 3.0f / pinch;
-            float multiplier = std::pow(2.0f, (ratio - 0.5f) * octaveSpread);
-            float stageFreq = juce::jlimit(20.0f, nyquist, safeFreq * multiplier);
+            const double ratio = numStages > 1 ? i * ratioStep : 0.5;
 
             // Variazione del Q per stadio (evita risonanze troppo uniformi)
-            double stageQ = baseQ * (0.8 + ratio * 0.4);
+            const double stageQ = baseQ * (0.8 + ratio * 0.4);
+
+            // Q sotto la soglia di stabilità: stadio in passthrough
+            target.multiplier[i] = multiplier;
+            target.invTwoQ[i] = 0.5 / juce::jmax(stageQ, minQ);
+            target.weight[i] = stageQ < minQ ? 0.0 : 1.0;
 
-            // Aggiorna entrambi i canali con gli stessi valori (mono-compatible)
-            filters[0][i].updateCoeffs(stageFreq, stageQ);
-            filters[1][i].updateCoeffs(stageFreq, stageQ);
+            multiplier *= multiplierStep;
+        }
+
+        // Stadi fuori dalla cascata: passthrough
+        for (int i = numStages; i < MAX_STAGES; ++i)
+        {
+            target.multiplier[i] = 1.0;
+            target.invTwoQ[i] = 0.5;
+            target.weight[i] = 0.0;
         }
     }
 
+    /**
+     * sin(x) e cos(x) per x in [0, pi/2]: Taylor fino a x^13 / x^14
+     * (errore < 1e-9). Solo polinomi: niente sqrt né chiamate di libreria,
+     * il loop dei coefficienti resta vettorizzabile
+     */
+    static double fastSin(double x) noexcept
+    {
+        const double x2 = x * x;
+        return x * (1.0 + x2 * (-1.0 / 6.0 + x2 * (1.0 / 120.0 + x2 * (-1.0 / 5040.0
+                 + x2 * (1.0 / 362880.0 + x2 * (-1.0 / 39916800.0 + x2 * (1.0 / 6227020800.0)))))));
+    }
+
+    static double fastCos(double x) noexcept
+    {
+        const double x2 = x * x;
+        return 1.0 + x2 * (-1.0 / 2.0 + x2 * (1.0 / 24.0 + x2 * (-1.0 / 720.0 + x2 * (1.0 / 40320.0
+                 + x2 * (-1.0 / 3628800.0 + x2 * (1.0 / 479001600.0 + x2 * (-1.0 / 87178291200.0)))))));
+    }
+
+    /**
+     * Coefficienti di tutti gli stadi per una frequenza base (kernel vettoriale).
+     * Allpass RBJ con w0 = 2*theta: sin(w0) = 2sc, cos(w0) = 1 - 2s^2,
+     * s = sin(theta), c = cos(theta), theta in [0, 0.49*pi]; nessun branch
+     * nel loop.
+     * Il peso sfuma linearmente tra passthrough (b0 = 1) e allpass: i poli
+     * restano nel triangolo di stabilità per ogni peso in [0, 1].
+     */
+    static void computeRow(Coefficients& row, const StageLayout& stages, int numStages,
+                           double baseFrequency, double sampleRate)
+    {
+        const double nyquist = sampleRate * 0.49;
+        const double base = juce::jlimit(20.0, nyquist, baseFrequency);
+        const double piOverSampleRate = juce::MathConstants<double>::pi / sampleRate;
+
+        for (int i = 0; i < numStages; ++i)
+        {
+            // Clamp con select (min/max per riferimento impediscono la vettorizzazione)
+            const double unclamped = base * stages.multiplier[i];
+            const double aboveMin = unclamped > 20.0 ? unclamped : 20.0;
+            const double stageFreq = aboveMin < nyquist ? aboveMin : nyquist;
+            const double theta = stageFreq * piOverSampleRate;
+            const double s = fastSin(theta);
+            const double s2 = s * s;
+
+            const double alpha = 2.0 * s * fastCos(theta) * stages.invTwoQ[i];
+            const double invA0 = 1.0 / (1.0 + alpha);
+            const double c0 = (1.0 - alpha) * invA0;
+            const double c1 = -2.0 * (1.0 - 2.0 * s2) * invA0;
+            const double w = stages.weight[i];
+
+            row.b0[i] = 1.0 + w * (c0 - 1.0);
+            row.b1[i] = w * c1;
+            row.b2[i] = w;
+            row.a1[i] = w * c1;
+            row.a2[i] = w * c0;
+        }
+    }
+
+    /**
+     * ═══════════════════════════════════════════════════════════════════════
+     * IR DESIGNER (thread in background)
+     * ═══════════════════════════════════════════════════════════════════════
+     * Calcola la risposta all'impulso della cascata con i parametri correnti
+     * e la passa a Convolution. Le richieste arrivano da qualsiasi thread
+     * (solo atomici + notify). Un design iniziato arriva sempre in fondo:
+     * interromperlo a ogni nuova richiesta lascerebbe Convolution senza IR
+     * per tutta la durata di un'automazione. Dopo ogni design il thread
+     * attende MIN_DESIGN_INTERVAL_MS, e le richieste arrivate nel frattempo
+     * producono un solo design con i valori più recenti.
+     */
+    class IRDesigner : private juce::Thread
+    {
+    public:
+        explicit IRDesigner(juce::OwnedArray<juce::dsp::Convolution>& targets)
+            : juce::Thread("SubSaver Disperser IR"), convolutions(targets)
+        {
+        }
+
+        ~IRDesigner() override
+        {
+            stopThread(2000);
+        }
+
+        // Il thread usa cascade, sampleRate e i motori: fermo mentre cambiano
+        void stop()
+        {
+            stopThread(2000);
+        }
+
+        void prepare(double sr, int numTargets)
+        {
+            stop();
+            sampleRate = sr;
+            numConvolutions = numTargets;
+            cascade.prepare(DESIGN_BLOCK_SIZE);
+            startThread();
+        }
+
+        // Restituisce il numero di serie della richiesta
+        int requestDesign(float amount, float freq, float pinch, int numStages)
+        {
+            pendingAmount = amount;
+            pendingFrequency = freq;
+            pendingPinch = pinch;
+            pendingStages = numStages;
+            const int serial = ++requestedDesigns;
+
+            // Con un design già in attesa basta aggiornare i valori
+            if (!designRequested.exchange(true))
+                notify();
+
+            return serial;
+        }
+
+        // La IR della richiesta serial (o di una più recente) è stata consegnata a Convolution
+        bool isDesignDelivered(int serial) const noexcept
+        {
+            return deliveredDesigns.load() >= serial;
+        }
+
+        // Lunghezza dell'ultima IR consegnata (Convolution la installa in modo asincrono)
+        int getDeliveredLength() const noexcept
+        {
+            return deliveredLength.load();
+        }
+
+    private:
+        static constexpr int DESIGN_BLOCK_SIZE = 4096;
+        static constexpr float TAIL_THRESHOLD = 1.0e-5f; // -100dB
+        static constexpr int TAIL_FADE = 64;
+        static constexpr juce::uint32 MIN_DESIGN_INTERVAL_MS = 100;
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                if (!designRequested.exchange(false))
+                {
+                    wait(-1);
+                    continue;
+                }
+
+                // Il serial va letto prima dei valori: una richiesta che arriva
+                // a metà rialza designRequested e viene rifatta
+                const int serial = requestedDesigns.load();
+                if (!design(pendingAmount, pendingFrequency, pendingPinch, pendingStages))
+                    return;
+
+                deliveredDesigns = serial;
+
+                // Limite di frequenza: notify durante l'attesa non la accorcia
+                const auto resume = juce::Time::getMillisecondCounter() + MIN_DESIGN_INTERVAL_MS;
+                for (auto now = juce::Time::getMillisecondCounter(); now < resume && !threadShouldExit();
+                     now = juce::Time::getMillisecondCounter())
+                    wait(static_cast<int>(resume - now));
+            }
+        }
+
+        // false solo se il thread deve uscire
+        bool design(float amount, float freq, float pinch, int numStages)
+        {
+            juce::AudioBuffer<float> ir(1, MAX_IR_LENGTH);
+            ir.clear();
+            ir.setSample(0, 0, 1.0f);
+
+            // Come il bypass della cascata: amount ~0 = impulso unitario
+            int length = 1;
+
+            if (amount >= 0.005f)
+            {
+                designLayout(layout, numStages, amount, pinch);
+                computeRow(coefficients, layout, numStages, freq, sampleRate);
+                cascade.reset();
+                cascade.setCoefficients(coefficients);
+
+                for (int start = 0; start < MAX_IR_LENGTH; start += DESIGN_BLOCK_SIZE)
+                {
+                    if (threadShouldExit())
+                        return false;
+
+                    float* channels[] = { ir.getWritePointer(0, start) };
+                    cascade.process(channels, 1, juce::jmin(DESIGN_BLOCK_SIZE, MAX_IR_LENGTH - start), numStages);
+                }
+
+                // Coda: taglia sotto -100dB con un breve fade-out
+                const float* data = ir.getReadPointer(0);
+                int last = MAX_IR_LENGTH - 1;
+                while (last > 0 && std::abs(data[last]) < TAIL_THRESHOLD)
+                    --last;
+
+                length = juce::jmin(MAX_IR_LENGTH, last + 1 + TAIL_FADE);
+                const int fadeStart = juce::jmax(0, length - TAIL_FADE);
+                ir.applyGainRamp(0, fadeStart, length - fadeStart, 1.0f, 0.0f);
+            }
+
+            ir.setSize(1, length, true);
+
+            // Stessa IR per ogni coppia di canali (una copia per motore)
+            for (int pair = 0; pair < numConvolutions; ++pair)
+            {
+                juce::AudioBuffer<float> pairIR(ir);
+                convolutions[pair]->loadImpulseResponse(std::move(pairIR), sampleRate,
+                                                        juce::dsp::Convolution::Stereo::no,
+                                                        juce::dsp::Convolution::Trim::no,
+                                                        juce::dsp::Convolution::Normalise::no);
+            }
+
+            deliveredLength = length;
+            return true;
+        }
+
+        juce::OwnedArray<juce::dsp::Convolution>& convolutions;
+        int numConvolutions = 1;
+        AllpassCascade<MAX_STAGES> cascade;
+        StageLayout layout;
+        Coefficients coefficients;
+        double sampleRate = 44100.0;
+
+        std::atomic<float> pendingAmount { 0.0f };
+        std::atomic<float> pendingFrequency { 1000.0f };
+        std::atomic<float> pendingPinch { 1.0f };
+        std::atomic<int> pendingStages { Parameters::defaultDisperserStages };
+        std::atomic<bool> designRequested { false };
+        std::atomic<int> requestedDesigns { 0 };
+        std::atomic<int> deliveredDesigns { 0 };
+        std::atomic<int> deliveredLength { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE(IRDesigner)
+    };
+
     double sampleRate = 44100.0;
 
-    // Parametri correnti (no smoothing, gestito dall'interpolazione dei coefficienti)
+    // Parametri correnti (target: la cascata li raggiunge con smoothing e rampe)
     float currentAmount = 0.0f;
     float currentFrequency = 1000.0f;
     float currentPinch = 1.0f;
+    float envModAmount = 0.0f;
+    int numStages = Parameters::defaultDisperserStages;
+    int processedStages = Parameters::defaultDisperserStages; // >= numStages durante le transizioni
+
+    // Frequenza base smussata, disposizione corrente/target/passo della rampa
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> frequency;
+    StageLayout layout, layoutTarget, layoutStep;
+    int layoutRampBlocks = 0;
+    bool layoutPending = false;   // Setter chiamati, updateLayout al prossimo blocco
+    bool tailPending = true;      // Parametri cambiati, coda da ricalcolare
+    int cascadeTailSamples = 0;
+
+    // Banco di MAX_STAGES stadi in cascata, coefficienti condivisi dai canali
+    AllpassCascade<MAX_STAGES> cascade;
 
-    // Array dei filtri: 2 canali (L/R) × 16 stadi in cascata
-    std::array<std::array<BiquadAllpass, MAX_STAGES>, 2> filters;
+    // Modalità convolution (IR della stessa cascata)
+    std::atomic<Mode> requestedMode { Mode::Cascade };
+    Mode activeMode = Mode::Cascade;
+    Mode fadeFromMode = Mode::Cascade;
+    Crossfade modeFade { CROSSFADE_SAMPLES };
+    juce::AudioBuffer<float> fadeBuffer;    // Uscita del motore uscente durante il crossfade
+    juce::dsp::ConvolutionMessageQueue convolutionQueue;    // Caricamento IR condiviso dai motori
+    juce::OwnedArray<juce::dsp::Convolution> convolutions;  // Uno per coppia di canali, creati in prepareToPlay
+    int numConvolutions = 1;
+    int convolutionDesign = 0;              // Richiesta il cui design abilita il passaggio a Convolution
+    bool convolutionWarmup = false;         // Motori in ombra prima del passaggio a Convolution
+    int warmupSamples = 0;                  // Sample elaborati in ombra
+    IRDesigner designer;
+    WorkerPool* workerPool = nullptr;       // Modalità Multithread (nullptr: tutto in serie)
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Disperser)
 };
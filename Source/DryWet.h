@@ -1,12 +1,267 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Crossfade.h"
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * COMPENSATION DELAY
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Ritardo intero multicanale su circular buffer, dimensionato in prepare per
+ * il ritardo massimo: cambiare ritardo non alloca e non svuota il buffer, il
+ * tap vecchio sfuma nel nuovo con un crossfade. Un cambio che arriva durante
+ * un crossfade viene applicato alla sua fine (un solo crossfade alla volta:
+ * ripartire a metà farebbe saltare il segnale già sfumato).
+ *
+ * Le letture sono viste sul ring (getTap, al più due tratti contigui), così
+ * chi mescola il segnale ritardato non deve prima copiarlo altrove.
+ *
+ * Usato per allineare il dry al wet (DryWet) e per il padding di latenza
+ * della modalità a latenza costante (SubSaverAudioProcessor).
+ */
+class CompensationDelay
+{
+public:
+    /** Blocco ritardato come vista sul ring: al più due tratti contigui (wrap) */
+    struct Tap
+    {
+        const float* first = nullptr;
+        int firstLength = 0;
+        const float* second = nullptr;
+        int secondLength = 0;
+    };
+
+    CompensationDelay() = default;
+
+    void prepare(int numChannels, int maxNumSamples, int maxDelay, int initialDelay)
+    {
+        jassert(maxDelay >= 0);
+
+        // Assicurati che il buffer sia abbastanza grande: la lettura con
+        // ritardo maxDelay non deve sovrascriversi con il blocco appena scritto
+        int safeDelaySize = juce::jmax(maxDelay + maxNumSamples, maxNumSamples * 2);
+
+        delayBuffer.setSize(numChannels, safeDelaySize);
+        fadeSignal.setSize(numChannels, maxNumSamples);
+        reset();
+
+        delaySamples = juce::jlimit(0, maxDelay, initialDelay);
+        previousDelaySamples = delaySamples;
+        pendingDelaySamples = delaySamples;
+    }
+
+    void release()
+    {
+        delayBuffer.setSize(0, 0);
+        fadeSignal.setSize(0, 0);
+    }
+
+    // Svuota la storia (il ritardo passa subito al target, senza crossfade)
+    void reset()
+    {
+        delayBuffer.clear();
+        fadeSignal.clear();
+        delayFade.reset();
+        delaySamples = pendingDelaySamples;
+        previousDelaySamples = delaySamples;
+        writePosition = 0;
+    }
+
+    /**
+     * @param crossfade false quando l'uscita del delay non è udibile (es. il
+     *        bypass mentre la catena suona): il tap cambia subito, senza
+     *        crossfade né rinvii
+     */
+    void setDelaySamples(int samples, bool crossfade = true)
+    {
+        // CONTROLLO SICUREZZA: non superare mai la dimensione del buffer
+        int maxAllowedDelay = delayBuffer.getNumSamples() - 1;
+
+        if (samples > maxAllowedDelay)
+        {
+            // Usa il massimo possibile senza crashare
+            samples = maxAllowedDelay;
+        }
+        else
+        {
+            samples = juce::jlimit(0, maxAllowedDelay, samples);
+        }
+
+        pendingDelaySamples = samples;
+
+        if (!crossfade)
+        {
+            delayFade.reset();
+            delaySamples = samples;
+            previousDelaySamples = samples;
+            return;
+        }
+
+        // Niente clear del buffer: crossfade dal tap corrente al nuovo,
+        // rimandato ad advance() se un crossfade è già in corso
+
+        if (!delayFade.isActive())
+            startPendingCrossfade();
+    }
+
+    // Ritardo target (quello raggiunto a fine crossfade)
+    int getDelaySamples() const { return pendingDelaySamples; }
 
+    bool isCrossfading() const noexcept { return delayFade.isActive(); }
+
+    /**
+     * Scrive il blocco corrente nel ring, una sola volta per blocco: le
+     * letture (getTap, read) vedono il blocco fino ad advance().
+     */
+    void write(const juce::AudioBuffer<float>& source, int numChannels, int numSamples)
+    {
+        const int delayBufferSize = delayBuffer.getNumSamples();
+        jassert(numSamples <= delayBufferSize && numChannels <= delayBuffer.getNumChannels());
+
+        // Al più un wrap: due copie contigue, nessun modulo per sample
+        const int firstLength = juce::jmin(numSamples, delayBufferSize - writePosition);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* input = source.getReadPointer(ch);
+            float* ring = delayBuffer.getWritePointer(ch);
+
+            juce::FloatVectorOperations::copy(ring + writePosition, input, firstLength);
+            juce::FloatVectorOperations::copy(ring, input + firstLength, numSamples - firstLength);
+        }
+    }
+
+    // Vista sul blocco ritardato al tap corrente (valida fino ad advance)
+    Tap getTap(int channel, int numSamples) const noexcept
+    {
+        return getTap(channel, delaySamples, numSamples);
+    }
+
+    // Copia il blocco ritardato in destination, sfumando tra i tap se serve
+    void read(juce::AudioBuffer<float>& destination, int numChannels, int numSamples)
+    {
+        if (delayFade.isActive())
+        {
+            readTap(fadeSignal, previousDelaySamples, numChannels, numSamples);
+            readTap(destination, delaySamples, numChannels, numSamples);
+            delayFade.process(destination.getArrayOfWritePointers(), fadeSignal.getArrayOfReadPointers(),
+                              numChannels, numSamples);
+        }
+        else
+        {
+            readTap(destination, delaySamples, numChannels, numSamples);
+        }
+    }
+
+    // Chiude il blocco: avanza la write position, parte il crossfade rimandato
+    void advance(int numSamples) noexcept
+    {
+        writePosition += numSamples;
+        if (writePosition >= delayBuffer.getNumSamples())
+            writePosition -= delayBuffer.getNumSamples();
+
+        if (!delayFade.isActive())
+            startPendingCrossfade();
+    }
+
+    bool isValid() const noexcept
+    {
+        const int delayBufferSize = delayBuffer.getNumSamples();
+        return delayBufferSize > 0 && delaySamples < delayBufferSize && previousDelaySamples < delayBufferSize;
+    }
+
+    /**
+     * Ritarda in-place i primi numChannels canali del buffer.
+     * Il ring è scritto anche a ritardo zero: un cambio di ritardo trova già
+     * la storia del segnale e sfuma dal tap vecchio al nuovo.
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples)
+    {
+        // VERIFICA: controllo sicurezza
+        if (!isValid())
+        {
+            jassertfalse;
+            return;
+        }
+
+        write(buffer, numChannels, numSamples);
+
+        if (delayFade.isActive() || delaySamples > 0)
+            read(buffer, numChannels, numSamples);
+
+        advance(numSamples);
+    }
+
+private:
+    void startPendingCrossfade() noexcept
+    {
+        if (pendingDelaySamples != delaySamples)
+        {
+            previousDelaySamples = delaySamples;
+            delaySamples = pendingDelaySamples;
+            delayFade.start();
+        }
+    }
+
+    Tap getTap(int channel, int delay, int numSamples) const noexcept
+    {
+        const int delayBufferSize = delayBuffer.getNumSamples();
+
+        // Il blocco corrente inizia a writePosition: delay sample prima
+        int readPos = writePosition - delay;
+        if (readPos < 0)
+            readPos += delayBufferSize;
+
+        // VERIFICA: read position valida
+        jassert(readPos >= 0 && readPos < delayBufferSize);
+
+        const float* ring = delayBuffer.getReadPointer(channel);
+        const int firstLength = juce::jmin(numSamples, delayBufferSize - readPos);
+        return { ring + readPos, firstLength, ring, numSamples - firstLength };
+    }
+
+    void readTap(juce::AudioBuffer<float>& destination, int delay, int numChannels, int numSamples)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const Tap tap = getTap(ch, delay, numSamples);
+            float* output = destination.getWritePointer(ch);
+
+            juce::FloatVectorOperations::copy(output, tap.first, tap.firstLength);
+            juce::FloatVectorOperations::copy(output + tap.firstLength, tap.second, tap.secondLength);
+        }
+    }
+
+    static constexpr int CROSSFADE_SAMPLES = 512;   // ~10ms @ 48kHz
+
+    int delaySamples = 0;
+    int previousDelaySamples = 0;   // Tap uscente durante il crossfade
+    int pendingDelaySamples = 0;    // Target richiesto durante un crossfade
+    int writePosition = 0;
+    Crossfade delayFade { CROSSFADE_SAMPLES };
+    juce::AudioBuffer<float> fadeSignal;    // Segnale al tap uscente
+    juce::AudioBuffer<float> delayBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompensationDelay)
+};
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * DRY/WET
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * L'ingresso è scritto una sola volta nel ring del CompensationDelay e il mix
+ * legge il dry direttamente dalle viste sul ring (due tratti al wrap), senza
+ * copie intermedie. Le rampe di guadagno sono calcolate una volta per blocco
+ * e applicate con FloatVectorOperations a tutti i canali.
+ * Solo durante il crossfade tra tap (cambio di latenza) il dry passa da un
+ * buffer di appoggio.
+ */
 class DryWet
 {
 public:
-    DryWet(float defaultDry = 1.0f, float defaultWet = 1.0f, int defaultDelaySamples = 0)
-        : delaySamples(defaultDelaySamples)
+    DryWet(float defaultDry = 1.0f, float defaultWet = 1.0f)
     {
         dryLevel.setCurrentAndTargetValue(defaultDry);
         wetLevel.setCurrentAndTargetValue(defaultWet);
@@ -14,24 +269,18 @@ public:
 
     ~DryWet() {}
 
-    void prepareToPlay(double sampleRate, int maxNumSamples, int numChannels, int maxDelay)
+    void prepareToPlay(double sampleRate, int maxNumSamples, int numChannels, int maxDelay, int initialDelay)
     {
         // VERIFICA parametri
         jassert(sampleRate > 0.0);
         jassert(maxNumSamples > 0);
         jassert(numChannels > 0);
         jassert(maxDelay >= 0);
-        drySignal.setSize(numChannels, maxNumSamples);
-        drySignal.clear();
-
-        // Assicurati che il buffer sia abbastanza grande
-        int safeDelaySize = juce::jmax(maxDelay, maxNumSamples * 2);
-
-        delayBuffer.setSize(numChannels, safeDelaySize);
-        delayBuffer.clear();
-        delaySamples = maxDelay;
-        
-        writePosition = 0;
+        fadedDrySignal.setSize(numChannels, maxNumSamples);
+        fadedDrySignal.clear();
+        dryGains.allocate(static_cast<size_t>(maxNumSamples), true);
+        wetGains.allocate(static_cast<size_t>(maxNumSamples), true);
+        dryDelay.prepare(numChannels, maxNumSamples, maxDelay, initialDelay);
 
 
         dryLevel.reset(sampleRate, 0.01);
@@ -40,18 +289,17 @@ public:
 
     void releaseResources()
     {
-        drySignal.setSize(0, 0);
-        delayBuffer.setSize(0, 0);
+        fadedDrySignal.setSize(0, 0);
+        dryGains.free();
+        wetGains.free();
+        dryDelay.release();
     }
 
 
+    // Unica copia del dry: l'ingresso va nel ring del delay di compensazione
     void copyDrySignal(const juce::AudioBuffer<float>& inputBuffer)
     {
-        const int numChannels = inputBuffer.getNumChannels();
-        const int numSamples = inputBuffer.getNumSamples();
-
-        for (int ch = 0; ch < numChannels; ++ch)
-            drySignal.copyFrom(ch, 0, inputBuffer, ch, 0, numSamples);
+        dryDelay.write(inputBuffer, inputBuffer.getNumChannels(), inputBuffer.getNumSamples());
     }
 
     void mergeDryAndWet(juce::AudioBuffer<float>& wetBuffer)
@@ -59,149 +307,101 @@ public:
         const int numChannels = wetBuffer.getNumChannels();
         const int numSamples = wetBuffer.getNumSamples();
 
+        // VERIFICA: controllo sicurezza
+        if (!dryDelay.isValid())
+        {
+            jassertfalse;
+            return;
+        }
+
         // ═══════════════════════════════════════════════════════════════
-        // DELAY COMPENSATION
+        // RAMPE DI GUADAGNO
+        // FIX ZIPPER NOISE: getNextValue() una volta per sample (non per
+        // sample per canale), la stessa rampa vale per tutti i canali
         // ═══════════════════════════════════════════════════════════════
-        if (delaySamples > 0)
-        {
-            const int delayBufferSize = delayBuffer.getNumSamples();
+        const bool smoothing = dryLevel.isSmoothing() || wetLevel.isSmoothing();
 
-            // VERIFICA: controllo sicurezza
-            if (delayBufferSize == 0 || delaySamples >= delayBufferSize)
+        if (smoothing)
+        {
+            for (int i = 0; i < numSamples; ++i)
             {
-                jassertfalse;
-                return;
+                dryGains[i] = dryLevel.getNextValue();
+                wetGains[i] = wetLevel.getNextValue();
             }
+        }
 
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                // ═════════════════════════════════════════════════════════════
-                // 1. SCRIVI nel circular buffer
-                // ═════════════════════════════════════════════════════════════
-                int samplesRemaining = numSamples;
-                int sourceOffset = 0;
-                int writePos = writePosition;
-
-                while (samplesRemaining > 0)
-                {
-                    // Calcola quanti samples possiamo scrivere prima del wrap
-                    int samplesUntilWrap = delayBufferSize - writePos;
-                    int samplesToWrite = juce::jmin(samplesRemaining, samplesUntilWrap);
-
-                    // VERIFICA: bounds check esplicito
-                    jassert(writePos >= 0 && writePos < delayBufferSize);
-                    jassert(samplesToWrite > 0 && samplesToWrite <= delayBufferSize);
-                    jassert(sourceOffset >= 0 && sourceOffset + samplesToWrite <= numSamples);
-
-                    // Scrivi il chunk
-                    delayBuffer.copyFrom(ch, writePos, drySignal, ch, sourceOffset, samplesToWrite);
-
-                    // Avanza i puntatori
-                    samplesRemaining -= samplesToWrite;
-                    sourceOffset += samplesToWrite;
-                    writePos = (writePos + samplesToWrite) % delayBufferSize;
-                }
-
-                // ═════════════════════════════════════════════════════════════
-                // 2. LEGGI dal circular buffer (con delay compensation)
-                // ═════════════════════════════════════════════════════════════
-                samplesRemaining = numSamples;
-                int destOffset = 0;
-
-                // Calcola read position con modulo sicuro
-                int readPos = (writePosition - delaySamples + delayBufferSize) % delayBufferSize;
-
-                // VERIFICA: read position valida
-                jassert(readPos >= 0 && readPos < delayBufferSize);
-
-                while (samplesRemaining > 0)
-                {
-                    // Calcola quanti samples possiamo leggere prima del wrap
-                    int samplesUntilWrap = delayBufferSize - readPos;
-                    int samplesToRead = juce::jmin(samplesRemaining, samplesUntilWrap);
-
-                    // VERIFICA: bounds check esplicito
-                    jassert(readPos >= 0 && readPos < delayBufferSize);
-                    jassert(samplesToRead > 0 && samplesToRead <= delayBufferSize);
-                    jassert(destOffset >= 0 && destOffset + samplesToRead <= numSamples);
-
-                    // Leggi il chunk
-                    drySignal.copyFrom(ch, destOffset, delayBuffer, ch, readPos, samplesToRead);
-
-                    // Avanza i puntatori
-                    samplesRemaining -= samplesToRead;
-                    destOffset += samplesToRead;
-                    readPos = (readPos + samplesToRead) % delayBufferSize;
-                }
-            }
+        const float dryGain = dryLevel.getCurrentValue();
+        const float wetGain = wetLevel.getCurrentValue();
 
-            // 3. Aggiorna write position per il prossimo blocco
-            writePosition = (writePosition + numSamples) % delayBufferSize;
-        }
+        // ═══════════════════════════════════════════════════════════════
+        // DELAY COMPENSATION
+        // Durante il crossfade tra tap il dry è materializzato, altrimenti
+        // si legge direttamente dal ring
+        // ═══════════════════════════════════════════════════════════════
+        const bool fadingTap = dryDelay.isCrossfading();
+        if (fadingTap)
+            dryDelay.read(fadedDrySignal, numChannels, numSamples);
 
         // ═══════════════════════════════════════════════════════════════
         // DRY/WET MIXING
         // ═══════════════════════════════════════════════════════════════
-        if (dryLevel.isSmoothing() || wetLevel.isSmoothing())
+        for (int ch = 0; ch < numChannels; ++ch)
         {
-            // FIX ZIPPER NOISE: Smoothing attivo: loop SAMPLE-first
-            // Questo garantisce che getNextValue() sia chiamato una volta per sample,
-            // non una volta per sample per channel (che causerebbe zipper noise)
-            for (int i = 0; i < numSamples; ++i)
+            float* wet = wetBuffer.getWritePointer(ch);
+
+            CompensationDelay::Tap dry;
+            if (fadingTap)
+                dry = { fadedDrySignal.getReadPointer(ch), numSamples, nullptr, 0 };
+            else
+                dry = dryDelay.getTap(ch, numSamples);
+
+            if (smoothing)
+            {
+                juce::FloatVectorOperations::multiply(wet, wetGains, numSamples);
+                juce::FloatVectorOperations::addWithMultiply(wet, dry.first, dryGains, dry.firstLength);
+                juce::FloatVectorOperations::addWithMultiply(wet + dry.firstLength, dry.second,
+                                                             dryGains + dry.firstLength, dry.secondLength);
+            }
+            else
             {
-                float dryGain = dryLevel.getNextValue();
-                float wetGain = wetLevel.getNextValue();
+                if (wetGain != 1.0f)
+                    juce::FloatVectorOperations::multiply(wet, wetGain, numSamples);
 
-                for (int ch = 0; ch < numChannels; ++ch)
+                if (dryGain != 0.0f)
                 {
-                    float dry = drySignal.getSample(ch, i) * dryGain;
-                    float wet = wetBuffer.getSample(ch, i) * wetGain;
-                    wetBuffer.setSample(ch, i, dry + wet);
+                    juce::FloatVectorOperations::addWithMultiply(wet, dry.first, dryGain, dry.firstLength);
+                    juce::FloatVectorOperations::addWithMultiply(wet + dry.firstLength, dry.second,
+                                                                 dryGain, dry.secondLength);
                 }
             }
         }
-        else
-        {
-            // Nessun smoothing: operazioni vettoriali
-            float dryGain = dryLevel.getCurrentValue();
-            float wetGain = wetLevel.getCurrentValue();
 
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                wetBuffer.applyGain(ch, 0, numSamples, wetGain);
-                wetBuffer.addFrom(ch, 0, drySignal, ch, 0, numSamples, dryGain);
-            }
-        }
+        dryDelay.advance(numSamples);
     }
 
 
-    void setDryLevel(float value) { dryLevel.setTargetValue(value); }
-    void setWetLevel(float value) { wetLevel.setTargetValue(value); }
-    void setDelaySamples(int samples)
+    // Come mergeDryAndWet senza mix (catena sospesa): il blocco è già nel
+    // ring, avanzano solo delay e rampe di guadagno
+    void skip(int numSamples)
     {
-        // CONTROLLO SICUREZZA: non superare mai la dimensione del buffer
-        int maxAllowedDelay = delayBuffer.getNumSamples() - 1;
-
-        if (samples > maxAllowedDelay)
-        {
-            // Usa il massimo possibile senza crashare
-            delaySamples = maxAllowedDelay;
-        }
-        else
-        {
-            delaySamples = juce::jlimit(0, maxAllowedDelay, samples);
-        }
-        delayBuffer.clear();
-        writePosition = 0;
+        dryLevel.skip(numSamples);
+        wetLevel.skip(numSamples);
+        dryDelay.advance(numSamples);
     }
 
+
+    void setDryLevel(float value) { dryLevel.setTargetValue(value); }
+    void setWetLevel(float value) { wetLevel.setTargetValue(value); }
+    void setDelaySamples(int samples) { dryDelay.setDelaySamples(samples); }
+    int getDelaySamples() const { return dryDelay.getDelaySamples(); }
+
 private:
     SmoothedValue<float, ValueSmoothingTypes::Linear> dryLevel;
     SmoothedValue<float, ValueSmoothingTypes::Linear> wetLevel;
-    int delaySamples;
-    int writePosition = 0;
-    juce::AudioBuffer<float> drySignal;
-    juce::AudioBuffer<float> delayBuffer;
+    CompensationDelay dryDelay;
+    juce::AudioBuffer<float> fadedDrySignal;   // Dry solo durante il crossfade tra tap
+    juce::HeapBlock<float> dryGains;           // Rampe per sample del blocco corrente
+    juce::HeapBlock<float> wetGains;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DryWet);
 };
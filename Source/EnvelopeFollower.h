@@ -29,24 +29,29 @@ public:
     }
 
     // Genera envelope buffer (già scalato per env_amount)
-    void processBlock(const juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<double>& envelopeBuffer)
+    // channelGain: scala della somma dei canali (percorso mono: un canale
+    // vale per N canali identici; layout oltre lo stereo: normalizzazione)
+    void processBlock(const juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& envelopeBuffer,
+                      float channelGain = 1.0f)
     {
         const int numChannels = inputBuffer.getNumChannels();
         const int numSamples = inputBuffer.getNumSamples();
 
-        // Envelope mono
-        envelopeBuffer.setSize(1, numSamples, false, false, true);
+        // Envelope mono: il buffer è allocato in prepareToPlay per il blocco massimo
+        jassert(numSamples <= envelopeBuffer.getNumSamples());
         auto envData = envelopeBuffer.getWritePointer(0);
 
         for (int sample = 0; sample < numSamples; ++sample)
         {
-            // 1. Full-wave rectifier: somma L+R in valore assoluto
+            // 1. Full-wave rectifier: somma dei canali in valore assoluto
             float sum = 0.0f;
             for (int ch = 0; ch < numChannels; ++ch)
             {
                 sum += std::abs(inputBuffer.getSample(ch, sample));
             }
 
+            sum *= channelGain;
+
             // 2. Lowpass filter a 20Hz (one-pole smoothing)
             envelope += lpCoeff * (sum - envelope);
 
@@ -2,25 +2,240 @@
 
 #include <JuceHeader.h>
 #include "PluginParameters.h"
+#include "WorkerPool.h"
 #include <vector>
 #include <array>
 
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * CODE DEI FILTRI IIR
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Stima della coda dei moduli a ingresso fermo, per la sospensione in
+ * silenzio (SubSaverAudioProcessor) e getTailLengthSeconds.
+ * Soglia di silenzio -100dB, come il taglio della coda delle IR del disperser.
+ */
+namespace Tail
+{
+    static constexpr float SILENCE_THRESHOLD = 1.0e-5f;          // -100dB
+    static constexpr double TIME_CONSTANTS_TO_SILENCE = 11.513;  // ln(1e5)
+
+    /**
+     * Costante di tempo (sample) del polo più lento di un biquad, dal
+     * prototipo analogico: sigma = w0 (1/2Q - sqrt(1/4Q^2 - 1)), poli reali
+     * per Q < 0.5. Un allpass di 2° ordine ha group delay di ~2 costanti
+     * di tempo.
+     */
+    inline double getTimeConstantSamples(double frequency, double invTwoQ, double sampleRate)
+    {
+        const double w0 = juce::MathConstants<double>::twoPi * frequency;
+        const double sigma = w0 * (invTwoQ - std::sqrt(juce::jmax(0.0, invTwoQ * invTwoQ - 1.0)));
+        return sampleRate / sigma;
+    }
+}
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * BIQUAD CASCADE (BANCO MULTICANALE)
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * NumSections biquad in serie, applicati in un solo passaggio sul buffer,
+ * seguiti da un gain d'uscita (costante o in rampa lineare).
+ *
+ * CARATTERISTICHE:
+ * - Transposed Direct Form II, coefficienti normalizzati (a0 = 1)
+ * - Coefficienti condivisi dai canali, stato structure-of-arrays per
+ *   sezione (z1[lane], z2[lane]): i canali sono lane dello stesso loop, il
+ *   compilatore li vettorializza insieme
+ * - Fino a MAX_LANES canali, elaborati a gruppi di 8, 4, 2 e 1 lane (un
+ *   gruppo da 8 float riempie un registro AVX)
+ * - Usato da TiltFilter (low shelf + high shelf + gain) e dal DC blocker
+ *   di WaveshaperCore (highpass + allineamento ADAA + compensazione 0.5)
+ */
+template <int NumSections>
+class BiquadCascade
+{
+public:
+    static constexpr int MAX_LANES = Parameters::maxChannels;
+
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f;
+        float a1 = 0.0f, a2 = 0.0f;
+    };
+
+    BiquadCascade()
+    {
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& section : state)
+            section = {};
+    }
+
+    // Copia lo stato di una lane in un'altra (uscendo dal percorso mono)
+    void copyLaneState(int sourceLane, int destinationLane) noexcept
+    {
+        for (auto& section : state)
+        {
+            section.z1[static_cast<size_t>(destinationLane)] = section.z1[static_cast<size_t>(sourceLane)];
+            section.z2[static_cast<size_t>(destinationLane)] = section.z2[static_cast<size_t>(sourceLane)];
+        }
+    }
+
+    Coefficients& getSection(int index) noexcept
+    {
+        return sections[static_cast<size_t>(index)];
+    }
+
+    // Copia da coefficienti JUCE (già normalizzati), da usare fuori dall'audio thread
+    void setSection(int index, const juce::dsp::IIR::Coefficients<float>& coefficients) noexcept
+    {
+        jassert(coefficients.getFilterOrder() == 2);
+        const auto* raw = coefficients.getRawCoefficients();
+        sections[static_cast<size_t>(index)] = { raw[0], raw[1], raw[2], raw[3], raw[4] };
+    }
+
+    /**
+     * Processa in-place fino a MAX_LANES canali
+     * @param startGain gain d'uscita sul primo sample
+     * @param gainStep incremento per sample (0 per gain costante)
+     * @param pool se presente, gruppi di PARALLEL_LANES canali in parallelo
+     */
+    void process(float* const* channels, int numChannels, int numSamples,
+                 float startGain = 1.0f, float gainStep = 0.0f, WorkerPool* pool = nullptr) noexcept
+    {
+        jassert(numChannels <= MAX_LANES);
+
+        if (pool != nullptr && numChannels > PARALLEL_LANES)
+        {
+            pool->parallelFor((numChannels + PARALLEL_LANES - 1) / PARALLEL_LANES, [&](int task)
+            {
+                const int first = task * PARALLEL_LANES;
+                processRange(channels, first, juce::jmin(numChannels, first + PARALLEL_LANES), numSamples, startGain, gainStep);
+            });
+            return;
+        }
+
+        processRange(channels, 0, numChannels, numSamples, startGain, gainStep);
+    }
+
+private:
+    static constexpr int PARALLEL_LANES = 4;   // Canali per task con il WorkerPool
+
+    // Lane [first, end) a gruppi di larghezza costante: 1 e 2 canali restano un solo gruppo
+    void processRange(float* const* channels, int first, int end, int numSamples, float startGain, float gainStep) noexcept
+    {
+        for (; first + 8 <= end; first += 8)
+            processLanes<8>(channels, first, numSamples, startGain, gainStep);
+
+        if (first + 4 <= end)
+        {
+            processLanes<4>(channels, first, numSamples, startGain, gainStep);
+            first += 4;
+        }
+
+        if (first + 2 <= end)
+        {
+            processLanes<2>(channels, first, numSamples, startGain, gainStep);
+            first += 2;
+        }
+
+        if (first < end)
+            processLanes<1>(channels, first, numSamples, startGain, gainStep);
+    }
+
+    // Stato di una sezione, una colonna per lane
+    struct SectionState
+    {
+        std::array<float, MAX_LANES> z1 {}, z2 {};
+    };
+
+    template <int NumLanes>
+    struct LaneState
+    {
+        std::array<float, NumLanes> z1, z2;
+    };
+
+    template <int NumLanes>
+    void processLanes(float* const* channels, int firstLane, int numSamples, float startGain, float gainStep) noexcept
+    {
+        float* data[NumLanes];
+        for (int lane = 0; lane < NumLanes; ++lane)
+            data[lane] = channels[firstLane + lane];
+
+        // Stato del gruppo in variabili locali per tutta la durata del blocco
+        std::array<LaneState<NumLanes>, NumSections> s;
+        for (int k = 0; k < NumSections; ++k)
+        {
+            for (int lane = 0; lane < NumLanes; ++lane)
+            {
+                s[k].z1[lane] = state[k].z1[firstLane + lane];
+                s[k].z2[lane] = state[k].z2[firstLane + lane];
+            }
+        }
+
+        const auto c = sections;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float x[NumLanes];
+            for (int lane = 0; lane < NumLanes; ++lane)
+                x[lane] = data[lane][i];
+
+            for (int k = 0; k < NumSections; ++k)
+            {
+                for (int lane = 0; lane < NumLanes; ++lane)
+                {
+                    const float y = c[k].b0 * x[lane] + s[k].z1[lane];
+                    s[k].z1[lane] = c[k].b1 * x[lane] - c[k].a1 * y + s[k].z2[lane];
+                    s[k].z2[lane] = c[k].b2 * x[lane] - c[k].a2 * y;
+                    x[lane] = y;
+                }
+            }
+
+            const float gain = startGain + gainStep * static_cast<float>(i + 1);
+            for (int lane = 0; lane < NumLanes; ++lane)
+                data[lane][i] = x[lane] * gain;
+        }
+
+        for (int k = 0; k < NumSections; ++k)
+        {
+            for (int lane = 0; lane < NumLanes; ++lane)
+            {
+                state[k].z1[firstLane + lane] = s[k].z1[lane];
+                state[k].z2[firstLane + lane] = s[k].z2[lane];
+            }
+        }
+    }
+
+    std::array<Coefficients, NumSections> sections;
+    std::array<SectionState, NumSections> state;
+
+    JUCE_DECLARE_NON_COPYABLE(BiquadCascade)
+};
+
 /**
  * TiltFilter - Generic Tilt EQ Filter
  *
  * Un filtro tilt EQ che aumenta/diminuisce progressivamente
  * i bassi e gli alti attorno a una frequenza pivot.
  *
- * Implementato come combinazione di Low Shelf + High Shelf IIR.
+ * Implementato come combinazione di Low Shelf + High Shelf IIR, fusi con la
+ * compensazione di gain in un unico BiquadCascade.
  *
  * Parametri:
  * - tiltAmount: -12dB a +12dB (negativo = più bassi, positivo = più alti)
  * - pivotFreq: frequenza centrale dove il gain è 0dB (default 1kHz)
  *
  * Caratteristiche:
- * - Minimum phase (IIR)
- * - Latenza minima (~10-20 samples)
- * - Stereo (2 canali indipendenti)
+ * - Minimum phase (IIR): latenza zero, solo ritardo di gruppo dipendente
+ *   dalla frequenza attorno al pivot
+ * - Multicanale (fino a Parameters::maxChannels canali indipendenti)
+ * - Coefficienti in forma chiusa aggiornati a control rate durante lo
+ *   smoothing, senza allocazioni sull'audio thread
  */
 class TiltFilter
 {
@@ -34,24 +249,15 @@ public:
         tiltAmount.setCurrentAndTargetValue(defaultTiltAmount);
     }
 
-    void prepareToPlay(double sr, int maxBlockSize)
+    void prepareToPlay(double sr, int /*maxBlockSize*/)
     {
         sampleRate = sr;
         tiltAmount.reset(sr, 0.005);
         lastTiltAmount = tiltAmount.getCurrentValue();
 
-        juce::dsp::ProcessSpec spec;
-        spec.sampleRate = sr;
-        spec.maximumBlockSize = maxBlockSize;
-        spec.numChannels = 1;
-
-        for (int ch = 0; ch < 2; ++ch)
-        {
-            lowShelf[ch].prepare(spec);
-            highShelf[ch].prepare(spec);
-            lowShelf[ch].reset();
-            highShelf[ch].reset();
-        }
+        shelves.reset();
+        updatePivot();
+        updateCoefficients(lastTiltAmount);
     }
 
     void setTiltAmount(float tiltDB)
@@ -62,68 +268,138 @@ public:
     void setPivotFrequency(float freqHz)
     {
         pivotFrequency = juce::jlimit(100.0f, 10000.0f, freqHz);
+        updatePivot();
         updateCoefficients(tiltAmount.getCurrentValue());
     }
 
     void reset()
     {
-        for (int ch = 0; ch < 2; ++ch)
-        {
-            lowShelf[ch].reset();
-            highShelf[ch].reset();
-        }
+        shelves.reset();
+    }
+
+    // Il canale destinationChannel riprende dallo stato di sourceChannel
+    void copyChannelState(int sourceChannel, int destinationChannel)
+    {
+        shelves.copyLaneState(sourceChannel, destinationChannel);
+    }
+
+    // Con un pool (modalità Multithread) i gruppi di canali girano in parallelo
+    void setWorkerPool(WorkerPool* pool) noexcept
+    {
+        workerPool = pool;
     }
 
     void processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
     {
-        const int numChannels = buffer.getNumChannels();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), Cascade::MAX_LANES);
+        float* channels[Cascade::MAX_LANES] = {};
 
-        for (int i = 0; i < numSamples; ++i)
+        // Tilt fermo: coefficienti e gain costanti, un solo passaggio sul
+        // blocco (l'unico caso distribuito sul pool, senza sincronizzazioni
+        // ogni CONTROL_RATE sample)
+        if (!tiltAmount.isSmoothing())
         {
-            float currentTilt = tiltAmount.getNextValue();
-
-            if (std::abs(currentTilt - lastTiltAmount) > 0.001f)
+            const float tilt = tiltAmount.getCurrentValue();
+            if (std::abs(tilt - lastTiltAmount) > 0.001f)
             {
-                updateCoefficients(currentTilt);
-                lastTiltAmount = currentTilt;
+                updateCoefficients(tilt);
+                lastTiltAmount = tilt;
             }
 
             for (int ch = 0; ch < numChannels; ++ch)
-            {
-                float* channelData = buffer.getWritePointer(ch);
-                float sample = channelData[i];
+                channels[ch] = buffer.getWritePointer(ch);
 
-                sample = lowShelf[ch].processSample(sample);
-                sample = highShelf[ch].processSample(sample);
-                sample *= (1 - std::abs(currentTilt) * 0.01f);
-                channelData[i] = sample;
+            shelves.process(channels, numChannels, numSamples, 1 - std::abs(tilt) * 0.01f, 0.0f, workerPool);
+            return;
+        }
+
+        // Coefficienti aggiornati a control rate: un update ogni CONTROL_RATE sample
+        // durante lo smoothing, la compensazione di gain resta una rampa per-sample
+        for (int start = 0; start < numSamples; start += CONTROL_RATE)
+        {
+            const int count = juce::jmin(CONTROL_RATE, numSamples - start);
+            const float startTilt = tiltAmount.getCurrentValue();
+            const float endTilt = tiltAmount.isSmoothing() ? tiltAmount.skip(count) : startTilt;
+
+            if (std::abs(endTilt - lastTiltAmount) > 0.001f)
+            {
+                updateCoefficients(endTilt);
+                lastTiltAmount = endTilt;
             }
+
+            const float startGain = 1 - std::abs(startTilt) * 0.01f;
+            const float gainStep = ((1 - std::abs(endTilt) * 0.01f) - startGain) / static_cast<float>(count);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch] = buffer.getWritePointer(ch, start);
+
+            // Low shelf + high shelf + compensazione in un solo passaggio
+            shelves.process(channels, numChannels, count, startGain, gainStep);
         }
     }
 
+    // Coda a ingresso fermo: due shelf in serie alla frequenza pivot
+    int getTailSamples() const
+    {
+        const double timeConstant = Tail::getTimeConstantSamples(pivotFrequency, 0.5 / Q, sampleRate);
+        return static_cast<int>(std::ceil((4.0 + Tail::TIME_CONSTANTS_TO_SILENCE) * timeConstant));
+    }
+
+    // Shelf IIR a fase minima: nessuna latenza (solo group delay dipendente
+    // dalla frequenza, che il dry path non può compensare con un ritardo fisso)
     int getLatencySamples() const
     {
-        return 10;
+        return 0;
     }
 
 private:
-    void updateCoefficients(float currentTilt)
-    {
+    using Cascade = BiquadCascade<2>; // 0: low shelf, 1: high shelf
+    static constexpr int CONTROL_RATE = 16;
 
-        float lowGain = juce::Decibels::decibelsToGain(currentTilt);
-        float highGain = juce::Decibels::decibelsToGain(-currentTilt);
+    void updatePivot()
+    {
+        const double omega = juce::MathConstants<double>::twoPi * pivotFrequency / sampleRate;
+        cosOmega = std::cos(omega);
+        sinOmegaOverQ = std::sin(omega) / Q;
+    }
 
-        auto lowCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-            sampleRate, pivotFrequency, Q, lowGain);
+    /**
+     * Shelf RBJ in forma chiusa (stesse formule di IIR::Coefficients::makeLowShelf
+     * e makeHighShelf), scritti direttamente nelle sezioni del cascade.
+     * Il gain high è il reciproco del low: A_high = 1 / A_low.
+     */
+    void updateCoefficients(float currentTilt)
+    {
+        const double A = std::pow(10.0, currentTilt / 40.0); // sqrt del gain lineare
 
-        auto highCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-            sampleRate, pivotFrequency, Q, highGain);
+        writeShelf(shelves.getSection(0), A, false);
+        writeShelf(shelves.getSection(1), 1.0 / A, true);
+    }
 
-        for (int ch = 0; ch < 2; ++ch)
-        {
-            *lowShelf[ch].coefficients = *lowCoeffs;
-            *highShelf[ch].coefficients = *highCoeffs;
-        }
+    void writeShelf(Cascade::Coefficients& section, double A, bool isHighShelf) const noexcept
+    {
+        const double aMinus1 = A - 1.0;
+        const double aPlus1 = A + 1.0;
+        const double beta = sinOmegaOverQ * std::sqrt(A);
+        const double aMinus1TimesCos = aMinus1 * cosOmega;
+
+        // Il segno di cos(omega) distingue high shelf e low shelf
+        const double s = isHighShelf ? -1.0 : 1.0;
+        const double sTimesAMinus1Cos = s * aMinus1TimesCos;
+
+        const double b0 = A * (aPlus1 - sTimesAMinus1Cos + beta);
+        const double b1 = s * 2.0 * A * (aMinus1 - s * aPlus1 * cosOmega);
+        const double b2 = A * (aPlus1 - sTimesAMinus1Cos - beta);
+        const double a0 = aPlus1 + sTimesAMinus1Cos + beta;
+        const double a1 = -s * 2.0 * (aMinus1 + s * aPlus1 * cosOmega);
+        const double a2 = aPlus1 + sTimesAMinus1Cos - beta;
+
+        const double invA0 = 1.0 / a0;
+        section.b0 = static_cast<float>(b0 * invA0);
+        section.b1 = static_cast<float>(b1 * invA0);
+        section.b2 = static_cast<float>(b2 * invA0);
+        section.a1 = static_cast<float>(a1 * invA0);
+        section.a2 = static_cast<float>(a2 * invA0);
     }
 
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> tiltAmount;
@@ -131,214 +407,421 @@ private:
     float lastTiltAmount = 0.0f;
     double sampleRate;
     float Q;
-    juce::dsp::IIR::Filter<float> lowShelf[2];
-    juce::dsp::IIR::Filter<float> highShelf[2];
+    double cosOmega = 1.0;
+    double sinOmegaOverQ = 0.0;
+    Cascade shelves;
+    WorkerPool* workerPool = nullptr;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TiltFilter)
 };
 
 /**
  * ═══════════════════════════════════════════════════════════════════════════
- * BIQUAD ALLPASS CON COEFFICIENT INTERPOLATION
+ * ALLPASS CASCADE A CONTROL RATE
  * ═══════════════════════════════════════════════════════════════════════════
  *
- * Filtro allpass del secondo ordine con interpolazione automatica dei coefficienti
- * per eliminare zipper noise e artefatti durante i cambi di parametri.
+ * Cascata di filtri allpass del secondo ordine (Direct Form I, double) con
+ * coefficienti aggiornabili ogni CONTROL_RATE sample: i parametri possono
+ * essere modulati a audio rate senza zipper noise.
  *
  * CARATTERISTICHE:
  * - Risposta in ampiezza piatta (Unity Gain)
  * - Group delay dipendente dalla frequenza e Q
- * - Interpolazione lineare dei coefficienti su 64 samples (~1.5ms @ 44.1kHz)
+ * - Coefficienti e stati structure-of-arrays: i canali condividono i
+ *   coefficienti e sono lane dello stesso loop. Fino a MAX_LANES canali, a
+ *   gruppi di 4, 2 e 1 lane (4 double = un registro AVX; le copie locali
+ *   del fronte d'onda restano sullo stack)
+ * - Processing a fronte d'onda: gli stadi avanzano insieme sfasati di un
+ *   sample, il loop interno vettorializza su stadi e lane
+ * - Modulazione: la riga di coefficienti di ogni blocco di controllo viene
+ *   calcolata dal chiamante (computeRow) e ogni stadio la carica quando il
+ *   suo sample attraversa il confine del blocco (diagonale del fronte)
+ * - Processing in double su un buffer interleaved, una conversione float
+ *   in ingresso e una in uscita per l'intera cascata
  */
-class BiquadAllpass
+template <int MaxStages>
+class AllpassCascade
 {
 public:
-    static constexpr int INTERP_SAMPLES = 64; // Durata dell'interpolazione
+    static constexpr int MAX_LANES = Parameters::maxChannels;
+    static constexpr int MAX_GROUP_LANES = 4;  // Lane per passaggio del fronte d'onda
+    static constexpr int CONTROL_RATE = 8;  // Sample per riga di coefficienti
+
+    // Coefficienti normalizzati (a0 = 1), uno per stadio
+    struct Coefficients
+    {
+        std::array<double, MaxStages> b0, b1, b2, a1, a2;
+    };
 
-    BiquadAllpass()
+    AllpassCascade()
     {
         reset();
     }
 
     /**
-     * Prepara il filtro per l'audio processing
-     * @param sr Sample rate in Hz
+     * Prepara la cascata per l'audio processing
+     * @param maxBlockSize Numero massimo di sample per blocco
+     * @param numChannels Canali massimi: oltre un gruppo di lane le righe
+     *                    modulate sono calcolate prima e condivise dai gruppi
      */
-    void prepare(double sr)
+    void prepare(int maxBlockSize, int numChannels = 1)
     {
-        sampleRate = sr;
+        // Un buffer di lavoro per gruppo: i gruppi possono girare in parallelo
+        groupBufferSize = static_cast<size_t>(maxBlockSize) * MAX_GROUP_LANES;
+        workBuffer.assign(groupBufferSize * static_cast<size_t>(getNumGroups(numChannels)), 0.0);
+
+        rowCache.resize(hasMultipleGroups(numChannels) ? static_cast<size_t>((maxBlockSize + CONTROL_RATE - 1) / CONTROL_RATE) : 0);
         reset();
     }
 
     /**
-     * Resetta completamente il filtro (stati e coefficienti a unity gain)
+     * Resetta stati e coefficienti (unity gain passthrough)
      */
     void reset()
     {
-        // Stati del filtro (memoria)
-        x1 = x2 = y1 = y2 = 0.0;
+        for (int stage = 0; stage < MaxStages; ++stage)
+            setPassthrough(active, stage);
 
-        // Coefficienti correnti (unity gain passthrough)
-        b0 = 1.0; b1 = 0.0; b2 = 0.0;
-        a1 = 0.0; a2 = 0.0;
+        clearState();
+    }
 
-        // Coefficienti per interpolazione
-        oldB0 = targetB0 = b0;
-        oldB1 = targetB1 = b1;
-        oldB2 = targetB2 = b2;
-        oldA1 = targetA1 = a1;
-        oldA2 = targetA2 = a2;
+    /**
+     * Azzera solo la memoria dei filtri, i coefficienti restano
+     */
+    void clearState()
+    {
+        state = {};
+    }
 
-        interpolationCounter = INTERP_SAMPLES; // Non interpolare all'inizio
+    // Azzera la memoria di uno stadio che rientra nella cascata
+    void clearStage(int stage)
+    {
+        for (int lane = 0; lane < MAX_LANES; ++lane)
+        {
+            const int j = stage * MAX_LANES + lane;
+            state.x1[j] = state.x2[j] = state.y1[j] = state.y2[j] = 0.0;
+        }
+    }
+
+    // Copia la memoria di tutti gli stadi da una lane a un'altra
+    void copyLaneState(int sourceLane, int destinationLane)
+    {
+        for (int stage = 0; stage < MaxStages; ++stage)
+        {
+            const int from = stage * MAX_LANES + sourceLane;
+            const int to = stage * MAX_LANES + destinationLane;
+            state.x1[to] = state.x1[from]; state.x2[to] = state.x2[from];
+            state.y1[to] = state.y1[from]; state.y2[to] = state.y2[from];
+        }
     }
 
     /**
-     * Aggiorna i coefficienti del filtro (calcola i nuovi target e inizia l'interpolazione)
-     * @param freq Frequenza centrale in Hz
-     * @param Q Fattore di qualità (larghezza di banda)
+     * Porta lo stato delle lane 0/1 in base mid/side (toMidSide) o di nuovo
+     * in L/R: il filtro è lineare e uguale sulle lane, lo stato si trasforma
+     * come il segnale (M = (L + R) / 2, S = (L - R) / 2)
      */
-    void updateCoeffs(float freq, float Q)
+    void convertMidSideState(bool toMidSide)
     {
-        // Safeguard per Q molto bassi (filtro quasi disabilitato)
-        if (Q < 0.001)
+        const double scale = toMidSide ? 0.5 : 1.0;
+        auto convert = [scale](std::array<double, MaxStages * MAX_LANES>& values, int j)
         {
-            // Imposta target per unity gain (filtro trasparente)
-            targetB0 = 1.0; targetB1 = 0.0; targetB2 = 0.0;
-            targetA1 = 0.0; targetA2 = 0.0;
-        }
-        else
+            const double first = values[j], second = values[j + 1];
+            values[j] = (first + second) * scale;
+            values[j + 1] = (first - second) * scale;
+        };
+
+        for (int stage = 0; stage < MaxStages; ++stage)
         {
-            // Calcola i nuovi coefficienti allpass usando RBJ Audio EQ Cookbook
-            double omega = juce::MathConstants<double>::twoPi * freq / sampleRate;
-            double sn = std::sin(omega);
-            double cs = std::cos(omega);
-            double alpha = sn / (2.0 * Q);
-
-            double a0 = 1.0 + alpha;
-            double invA0 = 1.0 / a0;
-
-            // Coefficienti allpass 2° ordine
-            // Nota: per un allpass, numeratore e denominatore sono speculari
-            targetB0 = (1.0 - alpha) * invA0;
-            targetB1 = (-2.0 * cs) * invA0;
-            targetB2 = (1.0 + alpha) * invA0;
-            targetA1 = targetB1;  // Simmetria allpass
-            targetA2 = targetB0;  // Simmetria allpass
+            const int j = stage * MAX_LANES;
+            convert(state.x1, j); convert(state.x2, j);
+            convert(state.y1, j); convert(state.y2, j);
         }
+    }
 
-        // Salva i coefficienti correnti come punto di partenza per l'interpolazione
-        oldB0 = b0; oldB1 = b1; oldB2 = b2;
-        oldA1 = a1; oldA2 = a2;
+    void setCoefficients(const Coefficients& newCoefficients)
+    {
+        active = newCoefficients;
+    }
 
-        // Inizia l'interpolazione da zero
-        interpolationCounter = 0;
+    static void setPassthrough(Coefficients& c, int stage)
+    {
+        c.b0[stage] = 1.0; c.b1[stage] = 0.0; c.b2[stage] = 0.0;
+        c.a1[stage] = 0.0; c.a2[stage] = 0.0;
     }
 
     /**
-     * Processa un blocco di campioni audio
-     * @param data Puntatore ai sample da processare (in-place)
-     * @param numSamples Numero di campioni da processare
+     * Processa in-place i primi numStages stadi con coefficienti costanti.
+     * Con un WorkerPool i gruppi di lane girano in parallelo.
      */
-    void processBlock(float* data, int numSamples)
+    void process(float* const* channels, int numChannels, int numSamples, int numStages = MaxStages,
+                 WorkerPool* pool = nullptr)
     {
-        for (int i = 0; i < numSamples; ++i)
+        CachedRows noRows { nullptr };
+        processGroups<false>(channels, numChannels, numSamples, numStages, noRows, pool);
+    }
+
+    /**
+     * Processa con coefficienti aggiornati ogni CONTROL_RATE sample.
+     * computeRow(m, row) riempie i coefficienti del blocco di controllo m
+     * (sample [m * CONTROL_RATE, (m + 1) * CONTROL_RATE)) ed è chiamata una
+     * volta per blocco, in ordine. A fine blocco i coefficienti dell'ultima
+     * riga restano attivi per process().
+     */
+    template <typename RowFunction>
+    void processModulated(float* const* channels, int numChannels, int numSamples, int numStages,
+                          RowFunction&& computeRow, WorkerPool* pool = nullptr)
+    {
+        jassert(numChannels <= MAX_LANES);
+
+        // Un solo gruppo: righe calcolate al volo nel ring
+        if (!hasMultipleGroups(numChannels))
         {
-            // ═══════════════════════════════════════════════════════════════
-            // FASE 1: INTERPOLAZIONE DEI COEFFICIENTI
-            // ═══════════════════════════════════════════════════════════════
-            if (interpolationCounter < INTERP_SAMPLES)
-            {
-                // Calcola il fattore di interpolazione lineare [0.0 -> 1.0]
-                float alpha = (float)(interpolationCounter + 1) / (float)INTERP_SAMPLES;
-
-                // Interpola tutti i coefficienti simultaneamente
-                // Questo mantiene la stabilità del filtro e previene artefatti
-                b0 = oldB0 + alpha * (targetB0 - oldB0);
-                b1 = oldB1 + alpha * (targetB1 - oldB1);
-                b2 = oldB2 + alpha * (targetB2 - oldB2);
-                a1 = oldA1 + alpha * (targetA1 - oldA1);
-                a2 = oldA2 + alpha * (targetA2 - oldA2);
-
-                interpolationCounter++;
-            }
+            RingRows<RowFunction> ringRows { computeRow, rows };
+            processGroups<true>(channels, numChannels, numSamples, numStages, ringRows, pool);
+            return;
+        }
 
-            // ═══════════════════════════════════════════════════════════════
-            // FASE 2: DSP PROCESSING (BIQUAD DIFFERENCE EQUATION)
-            // ═══════════════════════════════════════════════════════════════
-            double input = data[i];
+        // computeRow fa avanzare smoothing e rampe: le righe del blocco sono
+        // calcolate una volta, prima, e lette da tutti i gruppi
+        const int numRows = (numSamples + CONTROL_RATE - 1) / CONTROL_RATE;
+        jassert(static_cast<size_t>(numRows) <= rowCache.size());
 
-            // Equazione alle differenze del biquad (Direct Form I)
-            // y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
-            double output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        for (int m = 0; m < numRows; ++m)
+            computeRow(m, rowCache[static_cast<size_t>(m)]);
 
-            // Anti-denormal: previene slowdown della CPU con numeri infinitesimi
-            if (std::abs(output) < 1.0e-20)
-                output = 0.0;
+        CachedRows cachedRows { rowCache.data() };
+        processGroups<true>(channels, numChannels, numSamples, numStages, cachedRows, pool);
+    }
 
-            // Aggiorna gli stati per il prossimo sample
-            x2 = x1; x1 = input;
-            y2 = y1; y1 = output;
+private:
+    // Righe in uso contemporaneamente: lo stadio k al passo t usa la riga
+    // (t - k) / CONTROL_RATE, quindi al più MaxStages / CONTROL_RATE + 2
+    static constexpr int NUM_ROWS = MaxStages / CONTROL_RATE + 2;
 
-            data[i] = static_cast<float>(output);
-        }
+    // Stati Direct Form I (memoria), indice stadio * MAX_LANES + lane
+    struct StageStates
+    {
+        std::array<double, MaxStages * MAX_LANES> x1 {}, x2 {}, y1 {}, y2 {};
+    };
+
+    // Righe calcolate al volo da computeRow in un ring di NUM_ROWS
+    template <typename RowFunction>
+    struct RingRows
+    {
+        RowFunction& computeRow;
+        std::array<Coefficients, NUM_ROWS>& ring;
+
+        void prepare(int m) { computeRow(m, ring[static_cast<size_t>(m % NUM_ROWS)]); }
+        const Coefficients& get(int m) const noexcept { return ring[static_cast<size_t>(m % NUM_ROWS)]; }
+    };
+
+    // Righe già calcolate per tutto il blocco (sola lettura, condivise dai gruppi)
+    struct CachedRows
+    {
+        const Coefficients* cache;
+
+        void prepare(int) const noexcept {}
+        const Coefficients& get(int m) const noexcept { return cache[m]; }
+    };
+
+    // Gruppi da MAX_GROUP_LANES lane (l'ultimo può essere più stretto)
+    static int getNumGroups(int numChannels) noexcept
+    {
+        return juce::jmax(1, (numChannels + MAX_GROUP_LANES - 1) / MAX_GROUP_LANES);
     }
 
-    /**
-     * Processa un singolo sample (utile per real-time sample-by-sample processing)
-     * @param sample Il sample da processare
-     * @return Il sample processato
-     */
-    float processSample(float sample)
+    // Più di un passaggio del fronte d'onda (3 canali: gruppi da 2 + 1)
+    static bool hasMultipleGroups(int numChannels) noexcept
+    {
+        return numChannels > MAX_GROUP_LANES || numChannels == 3;
+    }
+
+    template <bool Modulated, typename Rows>
+    void processGroups(float* const* channels, int numChannels, int numSamples, int numStages,
+                       Rows& rowSource, WorkerPool* pool)
     {
-        // Interpola se necessario
-        if (interpolationCounter < INTERP_SAMPLES)
+        jassert(numChannels <= MAX_LANES);
+        jassert(static_cast<size_t>(numSamples) * MAX_GROUP_LANES <= groupBufferSize);
+
+        const int numGroups = getNumGroups(numChannels);
+        jassert(static_cast<size_t>(numGroups) * groupBufferSize <= workBuffer.size());
+
+        auto processGroup = [&](int group)
         {
-            float alpha = (float)(interpolationCounter + 1) / (float)INTERP_SAMPLES;
+            const int first = group * MAX_GROUP_LANES;
+            const int end = juce::jmin(numChannels, first + MAX_GROUP_LANES);
+            double* work = workBuffer.data() + static_cast<size_t>(group) * groupBufferSize;
+
+            if (end - first == 4)
+            {
+                processLanes<4, Modulated>(channels, work, first, numSamples, numStages, rowSource);
+                return;
+            }
 
-            b0 = oldB0 + alpha * (targetB0 - oldB0);
-            b1 = oldB1 + alpha * (targetB1 - oldB1);
-            b2 = oldB2 + alpha * (targetB2 - oldB2);
-            a1 = oldA1 + alpha * (targetA1 - oldA1);
-            a2 = oldA2 + alpha * (targetA2 - oldA2);
+            int lane = first;
+            if (lane + 2 <= end)
+            {
+                processLanes<2, Modulated>(channels, work, lane, numSamples, numStages, rowSource);
+                lane += 2;
+            }
 
-            interpolationCounter++;
-        }
+            if (lane < end)
+                processLanes<1, Modulated>(channels, work, lane, numSamples, numStages, rowSource);
+        };
+
+        // Gruppi indipendenti (stato per lane, righe in sola lettura). Con le
+        // righe al volo c'è sempre un solo gruppo, sul thread chiamante
+        if (pool != nullptr && numGroups > 1)
+            pool->parallelFor(numGroups, processGroup);
+        else
+            for (int group = 0; group < numGroups; ++group)
+                processGroup(group);
 
-        double input = sample;
-        double output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        // Ogni stadio ha caricato l'ultima riga del blocco: resta attiva
+        if constexpr (Modulated)
+        {
+            if (numSamples > 0 && numStages > 0)
+            {
+                const auto& last = rowSource.get((numSamples - 1) / CONTROL_RATE);
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    active.b0[stage] = last.b0[stage]; active.b1[stage] = last.b1[stage];
+                    active.b2[stage] = last.b2[stage]; active.a1[stage] = last.a1[stage];
+                    active.a2[stage] = last.a2[stage];
+                }
+            }
+        }
+    }
 
-        if (std::abs(output) < 1.0e-20)
-            output = 0.0;
+    template <int NumLanes, bool Modulated, typename Rows>
+    void processLanes(float* const* channels, double* work, int firstLane, int numSamples, int numStages, Rows& rowSource)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            for (int lane = 0; lane < NumLanes; ++lane)
+                work[i * NumLanes + lane] = channels[firstLane + lane][i];
 
-        x2 = x1; x1 = input;
-        y2 = y1; y1 = output;
+        processWavefront<NumLanes, Modulated>(work, firstLane, numSamples, numStages, rowSource);
 
-        return static_cast<float>(output);
+        for (int i = 0; i < numSamples; ++i)
+            for (int lane = 0; lane < NumLanes; ++lane)
+                channels[firstLane + lane][i] = static_cast<float>(work[i * NumLanes + lane]);
     }
 
     /**
-     * Verifica se il filtro sta ancora interpolando
-     * @return true se l'interpolazione è in corso
+     * Tutti gli stadi insieme a "fronte d'onda": al passo t lo stadio k
+     * elabora il sample t - k, ricevendo l'uscita dello stadio k - 1 dal
+     * passo precedente. Stadi e lane di un passo sono indipendenti, quindi il
+     * loop interno vettorializza su (stadio, lane) invece di restare legato
+     * alla latenza della ricorsione di ogni biquad.
+     * Nessun ritardo aggiunto: riempimento e svuotamento sono nel blocco.
+     * (niente check anti-denormal: ScopedNoDenormals attivo nel processBlock)
      */
-    bool isInterpolating() const
+    template <int NumLanes, bool Modulated, typename Rows>
+    void processWavefront(double* data, int firstLane, int numSamples, int numStages, Rows& rowSource)
     {
-        return interpolationCounter < INTERP_SAMPLES;
-    }
+        if (numSamples <= 0 || numStages <= 0)
+            return;
 
-private:
-    double sampleRate = 44100.0;
+        jassert(numStages <= MaxStages);
+
+        // Copie locali con indice j = stadio * NumLanes + lane: niente aliasing
+        // possibile, coefficienti e stati restano in registri vettoriali
+        std::array<double, MaxStages * NumLanes> b0, b1, b2, a1, a2, x1, x2, y1, y2;
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            for (int lane = 0; lane < NumLanes; ++lane)
+            {
+                const int j = stage * NumLanes + lane;
+                const int c = stage * MAX_LANES + firstLane + lane;
+                b0[j] = active.b0[stage]; b1[j] = active.b1[stage]; b2[j] = active.b2[stage];
+                a1[j] = active.a1[stage]; a2[j] = active.a2[stage];
+                x1[j] = state.x1[c]; x2[j] = state.x2[c];
+                y1[j] = state.y1[c]; y2[j] = state.y2[c];
+            }
+        }
+
+        auto step = [&](int t, int firstStage, int lastStage)
+        {
+            if constexpr (Modulated)
+            {
+                // Nuova riga quando il primo stadio entra in un blocco di controllo
+                if (t % CONTROL_RATE == 0 && t < numSamples)
+                    rowSource.prepare(t / CONTROL_RATE);
+
+                // Gli stadi con (t - k) multiplo di CONTROL_RATE caricano la riga del loro sample
+                for (int k = firstStage + (t - firstStage) % CONTROL_RATE; k <= lastStage; k += CONTROL_RATE)
+                {
+                    const auto& row = rowSource.get((t - k) / CONTROL_RATE);
+                    for (int lane = 0; lane < NumLanes; ++lane)
+                    {
+                        const int j = k * NumLanes + lane;
+                        b0[j] = row.b0[k]; b1[j] = row.b1[k]; b2[j] = row.b2[k];
+                        a1[j] = row.a1[k]; a2[j] = row.a2[k];
+                    }
+                }
+            }
+
+            // Dall'ultimo stadio al primo: l'ingresso dello stadio k è y1 dello
+            // stadio k - 1, letto prima di essere aggiornato in questo passo
+            for (int j = (lastStage + 1) * NumLanes - 1; j >= juce::jmax(firstStage, 1) * NumLanes; --j)
+            {
+                const double input = y1[j - NumLanes];
+                const double output = b0[j] * input + b1[j] * x1[j] + b2[j] * x2[j] - a1[j] * y1[j] - a2[j] * y2[j];
+                x2[j] = x1[j]; x1[j] = input;
+                y2[j] = y1[j]; y1[j] = output;
+            }
+
+            // Primo stadio: nuovo sample in ingresso
+            if (firstStage == 0)
+            {
+                for (int j = 0; j < NumLanes; ++j)
+                {
+                    const double input = data[t * NumLanes + j];
+                    const double output = b0[j] * input + b1[j] * x1[j] + b2[j] * x2[j] - a1[j] * y1[j] - a2[j] * y2[j];
+                    x2[j] = x1[j]; x1[j] = input;
+                    y2[j] = y1[j]; y1[j] = output;
+                }
+            }
+
+            // Uscita dell'ultimo stadio: sample t - (numStages - 1)
+            if (t >= numStages - 1)
+                for (int lane = 0; lane < NumLanes; ++lane)
+                    data[(t - numStages + 1) * NumLanes + lane] = y1[(numStages - 1) * NumLanes + lane];
+        };
+
+        // Stadi attivi al passo t: quelli con un sample valido (t - k in [0, numSamples))
+        const int numSteps = numSamples + numStages - 1;
 
-    // Coefficienti correnti (usati nel processing)
-    double b0, b1, b2, a1, a2;
+        int t = 0;
+        for (; t < juce::jmin(numStages - 1, numSteps); ++t)             // riempimento
+            step(t, juce::jmax(0, t - numSamples + 1), juce::jmin(numStages - 1, t));
 
-    // Coefficienti per l'interpolazione
-    double oldB0, oldB1, oldB2, oldA1, oldA2;           // Punto di partenza
-    double targetB0, targetB1, targetB2, targetA1, targetA2;  // Destinazione
+        for (; t < numSamples; ++t)                                       // regime: tutti gli stadi
+            step(t, 0, numStages - 1);
+
+        for (; t < numSteps; ++t)                                         // svuotamento
+            step(t, juce::jmax(0, t - numSamples + 1), juce::jmin(numStages - 1, t));
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            for (int lane = 0; lane < NumLanes; ++lane)
+            {
+                const int j = stage * NumLanes + lane;
+                const int c = stage * MAX_LANES + firstLane + lane;
+                state.x1[c] = x1[j]; state.x2[c] = x2[j];
+                state.y1[c] = y1[j]; state.y2[c] = y2[j];
+            }
+        }
+    }
 
-    int interpolationCounter = INTERP_SAMPLES;          // Contatore interpolazione
+    Coefficients active;                   // Coefficienti correnti
+    std::array<Coefficients, NUM_ROWS> rows; // Righe dei blocchi di controllo (ring)
 
-    // Stati del filtro (memoria)
-    double x1, x2, y1, y2;
+    StageStates state;
+    std::vector<double> workBuffer; // interleaved [sample][lane], un tratto per gruppo
+    size_t groupBufferSize = 0;
+    std::vector<Coefficients> rowCache; // Righe del blocco con più gruppi di lane
 
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadAllpass)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AllpassCascade)
 };
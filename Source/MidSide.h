@@ -0,0 +1,40 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * MID/SIDE
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Conversione in-place tra L/R e M/S su una coppia di canali:
+ *   M = (L + R) / 2, S = (L - R) / 2   ->   L = M + S, R = M - S
+ *
+ * Usata dal waveshaper (nel dominio sovracampionato, gli oversampler restano
+ * in L/R) e dal disperser (lineare e uguale sui due canali: in M/S il
+ * risultato non cambia, ma la side sotto soglia si può saltare).
+ */
+namespace MidSide
+{
+    inline void encode(float* left, float* right, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float mid = 0.5f * (left[i] + right[i]);
+            const float side = 0.5f * (left[i] - right[i]);
+            left[i] = mid;
+            right[i] = side;
+        }
+    }
+
+    inline void decode(float* mid, float* side, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float left = mid[i] + side[i];
+            const float right = mid[i] - side[i];
+            mid[i] = left;
+            side[i] = right;
+        }
+    }
+}
@@ -12,10 +12,22 @@ namespace Parameters
     static const juce::String nameEnvAmount = "envAmount";
     static const juce::String nameTilt = "colour";
     static const juce::String nameOversampling = "oversampling";
+    static const juce::String nameOversamplingFactor = "oversamplingFactor";
+    static const juce::String nameOversamplingFilter = "oversamplingFilter";
+    static const juce::String nameOfflineOversamplingFactor = "offlineOversamplingFactor";
+    static const juce::String nameOfflineOversamplingFilter = "offlineOversamplingFilter";
     static const juce::String nameDisperserAmount = "disperserAmount";
     static const juce::String nameDisperserFreq = "disperserFreq";
     static const juce::String nameDisperserPinch = "disperserPinch";
+    static const juce::String nameDisperserStages = "disperserStages";
+    static const juce::String nameDisperserMode = "disperserMode";
+    static const juce::String nameDisperserEnvMod = "disperserEnvMod";
 	static const juce::String nameMorph = "morph";
+    static const juce::String nameAntiAliasing = "antiAliasing";
+    static const juce::String nameConstantLatency = "constantLatency";
+    static const juce::String nameBypass = "bypass";
+    static const juce::String nameMidSide = "midSide";
+    static const juce::String nameMultithread = "multithread";
 
     // Default Values & Range
     static const float defaultDryLevel = 1.0f;
@@ -25,10 +37,26 @@ namespace Parameters
     static const float defaultEnvAmount = 1.0f;
     static const float defaultTilt = 0.0f;
     static const bool defaultOversampling = true;
+    static const int autoOversamplingFactor = 5;            // Auto: fattore dal sample rate
+    static const int defaultOversamplingFactor = autoOversamplingFactor; // 0..4 → 1x, 2x, 4x, 8x, 16x; 5 = Auto
+    static const int defaultOversamplingFilter = 1;         // 0 = Polyphase IIR, 1 = FIR Equiripple
+    static const int defaultOfflineOversamplingFactor = 4;  // 16x in bounce/export
+    static const int defaultOfflineOversamplingFilter = 1;
     static const float defaultDisperserAmount = 0.0f;
     static const float defaultDisperserFreq = 1000.0f;
     static const float defaultDisperserPinch = 1.0f;
+    static const int defaultDisperserStages = 16;
+    static const int minDisperserStages = 4;
+    static const int maxDisperserStages = 128;
+    static const int maxChannels = 16;          // Canali per bus (fino a 9.1.6), lane dei banchi di filtri
+    static const int defaultDisperserMode = 0;  // 0 = Cascade (IIR), 1 = Convolution
+    static const float defaultDisperserEnvMod = 0.0f;
     static const float defaultMorph = 1.0f;
+    static const int defaultAntiAliasing = 0;   // 0 = Off, 1 = ADAA 1st, 2 = ADAA 2nd
+    static const bool defaultConstantLatency = false; // Riporta sempre la latenza massima
+    static const bool defaultBypass = false;          // Esposto all'host come parametro di bypass
+    static const bool defaultMidSide = false;         // Shaping e disperser in mid/side
+    static const bool defaultMultithread = false;     // Lavoro per canale sul WorkerPool
 
     // Crea il layout parametri 
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
@@ -44,10 +72,25 @@ namespace Parameters
         params.push_back(std::make_unique<AudioParameterFloat>(nameEnvAmount, "Env Amount", 0.0f, 1.0f, defaultEnvAmount));
         params.push_back(std::make_unique<AudioParameterFloat>(nameTilt, "Colour", -12.0f, 12.0f, defaultTilt));
         params.push_back(std::make_unique<AudioParameterBool>(nameOversampling, "Oversampling", defaultOversampling));
+
+        const StringArray oversamplingFactors{ "1x", "2x", "4x", "8x", "16x" };
+        const StringArray oversamplingFilters{ "Polyphase IIR", "FIR Equiripple" };
+        params.push_back(std::make_unique<AudioParameterChoice>(nameOversamplingFactor, "Oversampling Factor", StringArray{ "1x", "2x", "4x", "8x", "16x", "Auto" }, defaultOversamplingFactor));
+        params.push_back(std::make_unique<AudioParameterChoice>(nameOversamplingFilter, "Oversampling Filter", oversamplingFilters, defaultOversamplingFilter));
+        params.push_back(std::make_unique<AudioParameterChoice>(nameOfflineOversamplingFactor, "Offline Oversampling Factor", oversamplingFactors, defaultOfflineOversamplingFactor));
+        params.push_back(std::make_unique<AudioParameterChoice>(nameOfflineOversamplingFilter, "Offline Oversampling Filter", oversamplingFilters, defaultOfflineOversamplingFilter));
         params.push_back(std::make_unique<AudioParameterFloat>(nameDisperserAmount, "Disperser Amount", 0.0f, 1.0f, defaultDisperserAmount));
         params.push_back(std::make_unique<AudioParameterFloat>(nameDisperserFreq, "Disperser Frequency",NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.3f), defaultDisperserFreq));
         params.push_back(std::make_unique<AudioParameterFloat>(nameDisperserPinch, "Disperser Pinch", 0.5f, 10.0f, defaultDisperserPinch));
+        params.push_back(std::make_unique<AudioParameterInt>(nameDisperserStages, "Disperser Stages", minDisperserStages, maxDisperserStages, defaultDisperserStages));
+        params.push_back(std::make_unique<AudioParameterChoice>(nameDisperserMode, "Disperser Mode", StringArray{ "Cascade", "Convolution" }, defaultDisperserMode));
+        params.push_back(std::make_unique<AudioParameterFloat>(nameDisperserEnvMod, "Disperser Env Mod", -1.0f, 1.0f, defaultDisperserEnvMod));
 		params.push_back(std::make_unique<AudioParameterFloat>(nameMorph, "Morph", 0.0f, 3.0f, defaultMorph));
+        params.push_back(std::make_unique<AudioParameterChoice>(nameAntiAliasing, "Anti-Aliasing", StringArray{ "Off", "ADAA 1st", "ADAA 2nd" }, defaultAntiAliasing));
+        params.push_back(std::make_unique<AudioParameterBool>(nameConstantLatency, "Constant Latency", defaultConstantLatency));
+        params.push_back(std::make_unique<AudioParameterBool>(nameBypass, "Bypass", defaultBypass));
+        params.push_back(std::make_unique<AudioParameterBool>(nameMidSide, "Mid/Side", defaultMidSide));
+        params.push_back(std::make_unique<AudioParameterBool>(nameMultithread, "Multithread", defaultMultithread));
 
         return { params.begin(), params.end() };
 
@@ -5,36 +5,101 @@
 
 //==============================================================================
 SubSaverAudioProcessor::SubSaverAudioProcessor()
-    : AbstractProcessor(), parameters(*this, nullptr, "SUBSAVER", Parameters::createParameterLayout()),
-    dryWetter(Parameters::defaultDryLevel, Parameters::defaultWetLevel, 0),
+    : juce::AudioProcessor(BusesProperties()
+                               .withInput("Input", juce::AudioChannelSet::stereo(), true)
+                               .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+    AbstractProcessor(), parameters(*this, nullptr, "SUBSAVER", Parameters::createParameterLayout()),
+    parameterValues(parameters),
+    dryWetter(Parameters::defaultDryLevel, Parameters::defaultWetLevel),
     waveshaper(Parameters::defaultDrive,Parameters::defaultStereoWidth,Parameters::defaultOversampling),
     envelopeFollower(Parameters::defaultEnvAmount),
     tiltFilterPre(0.0f, 1000.0f),  
     tiltFilterPost(0.0f, 1000.0f),
     disperser(Parameters::defaultDisperserAmount, Parameters::defaultDisperserFreq, Parameters::defaultDisperserPinch)
 {
-
-    Parameters::addListenerToAllParameters(parameters, this);
 }
 
 
 SubSaverAudioProcessor::~SubSaverAudioProcessor() {}
 
+SubSaverAudioProcessor::ParameterValues::ParameterValues(juce::AudioProcessorValueTreeState& apvts)
+    : dryLevel(apvts.getRawParameterValue(Parameters::nameDryLevel)),
+    wetLevel(apvts.getRawParameterValue(Parameters::nameWetLevel)),
+    drive(apvts.getRawParameterValue(Parameters::nameDrive)),
+    stereoWidth(apvts.getRawParameterValue(Parameters::nameStereoWidth)),
+    envAmount(apvts.getRawParameterValue(Parameters::nameEnvAmount)),
+    tilt(apvts.getRawParameterValue(Parameters::nameTilt)),
+    oversampling(apvts.getRawParameterValue(Parameters::nameOversampling)),
+    oversamplingFactor(apvts.getRawParameterValue(Parameters::nameOversamplingFactor)),
+    oversamplingFilter(apvts.getRawParameterValue(Parameters::nameOversamplingFilter)),
+    offlineOversamplingFactor(apvts.getRawParameterValue(Parameters::nameOfflineOversamplingFactor)),
+    offlineOversamplingFilter(apvts.getRawParameterValue(Parameters::nameOfflineOversamplingFilter)),
+    disperserAmount(apvts.getRawParameterValue(Parameters::nameDisperserAmount)),
+    disperserFreq(apvts.getRawParameterValue(Parameters::nameDisperserFreq)),
+    disperserPinch(apvts.getRawParameterValue(Parameters::nameDisperserPinch)),
+    disperserStages(apvts.getRawParameterValue(Parameters::nameDisperserStages)),
+    disperserMode(apvts.getRawParameterValue(Parameters::nameDisperserMode)),
+    disperserEnvMod(apvts.getRawParameterValue(Parameters::nameDisperserEnvMod)),
+    morph(apvts.getRawParameterValue(Parameters::nameMorph)),
+    antiAliasing(apvts.getRawParameterValue(Parameters::nameAntiAliasing)),
+    constantLatency(apvts.getRawParameterValue(Parameters::nameConstantLatency)),
+    bypass(apvts.getRawParameterValue(Parameters::nameBypass)),
+    midSide(apvts.getRawParameterValue(Parameters::nameMidSide)),
+    multithread(apvts.getRawParameterValue(Parameters::nameMultithread))
+{
+}
+
 //==============================================================================
 void SubSaverAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    preparedBlockSize = samplesPerBlock;
+
+    // Worker solo in modalità Multithread; accesa più tardi, il pool parte
+    // dal message thread (handleAsyncUpdate). Spin di due blocchi: fra un
+    // blocco e l'altro i worker non si parcheggiano
+    cancelPendingUpdate();
+    workerPool.setSpinTime(2.0 * samplesPerBlock / sampleRate);
+    if (parameterValues.multithread->load() > 0.5f)
+        startWorkerPool();
+    else
+        workerPool.stop();
+
+    // Stato corrente dei parametri prima di preparare i moduli
+    syncParameters();
 	waveshaper.prepareToPlay(sampleRate,samplesPerBlock, getTotalNumOutputChannels());
     
     tiltFilterPre.prepareToPlay(sampleRate, samplesPerBlock);
     tiltFilterPost.prepareToPlay(sampleRate, samplesPerBlock);
     envelopeFollower.prepareToPlay(sampleRate);
     envelopeBuffer.setSize(1, samplesPerBlock);
-    modulatedDriveBuffer.setSize(1, samplesPerBlock);
-	disperser.prepareToPlay(sampleRate, samplesPerBlock);
+	disperser.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
 
-    const int totalLatency = calculateTotalLatency(sampleRate);
+    // Latenza costante: l'host vede sempre il caso peggiore, il padding in
+    // uscita compensa la differenza con la configurazione in uso
+    const int processingLatency = calculateTotalLatency(sampleRate);
+    const int totalLatency = constantLatency ? calculateWorstCaseLatency() : processingLatency;
     setLatencySamples(totalLatency);
-    dryWetter.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels(), totalLatency);
+
+    // Il dry delay è dimensionato per la configurazione più lenta,
+    // così cambiare oversampling non richiede riallocazioni
+    dryWetter.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels(),
+                            calculateMaxLatency(), calculateDryDelay());
+    latencyPadding.prepare(getTotalNumOutputChannels(), samplesPerBlock,
+                           calculateWorstCaseLatency(), totalLatency - processingLatency);
+
+    // Bypass: dry ritardato della latenza riportata, così l'istanza in
+    // bypass resta allineata in fase con le altre tracce
+    bypassDelay.prepare(getTotalNumOutputChannels(), samplesPerBlock, calculateWorstCaseLatency(), totalLatency);
+    bypassSignal.setSize(getTotalNumOutputChannels(), samplesPerBlock);
+    bypassFade.reset();
+
+    silentSamples = 0;
+    identicalSamples = 0;
+    monoPath = false;
+    disperserMidSide = false;
+    quietSideSamples = 0;
+    tailSamples = calculateTailSamples();
+    tailLengthSeconds = tailSamples / sampleRate;
 
 #if JUCE_DEBUG
     juce::MessageManager::callAsync([totalLatency, sampleRate]()
@@ -47,37 +112,378 @@ void SubSaverAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
 void SubSaverAudioProcessor::releaseResources()
 {
     dryWetter.releaseResources();
+    cancelPendingUpdate();
+    workerPool.stop();
+    latencyPadding.release();
+    bypassDelay.release();
+    bypassSignal.setSize(0, 0);
 }
 
 void SubSaverAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    // Host che mappano il bypass sul nostro parametro continuano a
+    // chiamare processBlock: stesso percorso di processBlockBypassed
+    if (parameterValues.bypass->load() > 0.5f)
+    {
+        processBlockBypassed(buffer, midiMessages);
+        return;
+    }
+
     juce::ScopedNoDenormals noDenormals; // Non dimenticare!
 
+    // Uscita dal bypass: il ring del dry ha continuato a scorrere durante
+    // il bypass, la catena sfuma dal dry ritardato al segnale elaborato.
+    // Il padding invece contiene l'uscita di prima del bypass (la catena era
+    // ferma): riparte vuoto, mai audio vecchio
+    if (bypassed)
+    {
+        bypassed = false;
+        latencyPadding.reset();
+        bypassFade.start();
+    }
+
+    // Parametri letti una volta per blocco; i cambi strutturali (oversampling,
+    // ADAA, modalità del disperser) entrano qui, a confine di blocco, con un
+    // crossfade interno ai moduli. La latenza cambia solo con questi.
+    syncParameters();
+    waveshaper.updateConfiguration();
+    disperser.updateConfiguration();
+    updateLatency();
+
+    tailSamples = calculateTailSamples();
+    tailLengthSeconds = tailSamples / getSampleRate();
+
+    processInChunks(buffer, &SubSaverAudioProcessor::processChunk);
+}
+
+void SubSaverAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    if (!bypassed)
+    {
+        bypassed = true;
+        bypassFade.start();
+    }
+
+    // Solo durante il crossfade la catena gira ancora (percorso uscente).
+    // A regime il bypass costa le scritture e le letture dei ring (bypass e
+    // dry) e la latenza riportata resta quella dell'ultimo blocco elaborato
+    if (bypassFade.isActive())
+    {
+        syncParameters();
+        waveshaper.updateConfiguration();
+        disperser.updateConfiguration();
+        updateLatency();
+        tailSamples = calculateTailSamples();
+    }
+
+    processInChunks(buffer, &SubSaverAudioProcessor::processBypassedChunk);
+}
+
+juce::AudioProcessorParameter* SubSaverAudioProcessor::getBypassParameter() const
+{
+    return parameters.getParameter(Parameters::nameBypass);
+}
+
+void SubSaverAudioProcessor::processInChunks(juce::AudioBuffer<float>& buffer,
+                                             void (SubSaverAudioProcessor::*processFunction)(juce::AudioBuffer<float>&))
+{
     const int numSamples = buffer.getNumSamples();
 
+    // Ingresso mono su bus multicanale: i canali senza ingresso partono dal canale 0
+    for (int ch = getTotalNumInputChannels(); ch < buffer.getNumChannels(); ++ch)
+        buffer.copyFrom(ch, 0, buffer, 0, 0, numSamples);
+
+    if (numSamples <= preparedBlockSize)
+    {
+        (this->*processFunction)(buffer);
+        return;
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // RE-BLOCKING: alcuni host inviano blocchi più grandi di quello
+    // dichiarato in prepareToPlay. Invece di riallocare oversampler e
+    // buffer sull'audio thread, processa il blocco a pezzi della
+    // dimensione preparata (le view non allocano fino a 32 canali).
+    // ═══════════════════════════════════════════════════════════
+    for (int start = 0; start < numSamples; start += preparedBlockSize)
+    {
+        const int chunkSize = juce::jmin(preparedBlockSize, numSamples - start);
+        juce::AudioBuffer<float> chunk(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, chunkSize);
+        (this->*processFunction)(chunk);
+    }
+}
+
+void SubSaverAudioProcessor::processChunk(juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), bypassSignal.getNumChannels());
 
+    // Il ring del bypass segue sempre l'ingresso: entrando in bypass il
+    // tap trova già la storia del segnale
+    juce::AudioBuffer<float> delayedDry(bypassSignal.getArrayOfWritePointers(), numChannels, 0, numSamples);
+    const bool fadingFromBypass = bypassFade.isActive();
+
+    if (fadingFromBypass)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            delayedDry.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+        bypassDelay.process(delayedDry, numChannels, numSamples);
+    }
+    else
+    {
+        bypassDelay.write(buffer, numChannels, numSamples);
+        bypassDelay.advance(numSamples);
+    }
+
+    processEffect(buffer);
+
+    if (fadingFromBypass)
+        bypassFade.process(buffer.getArrayOfWritePointers(), delayedDry.getArrayOfReadPointers(), numChannels, numSamples);
+}
+
+void SubSaverAudioProcessor::processBypassedChunk(juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), bypassSignal.getNumChannels());
+
+    // Crossfade in ingresso al bypass: la catena elabora una copia
+    // dell'ingresso, che sfuma nel dry ritardato
+    juce::AudioBuffer<float> processed(bypassSignal.getArrayOfWritePointers(), numChannels, 0, numSamples);
+    const bool fadingToBypass = bypassFade.isActive();
+
+    if (fadingToBypass)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            processed.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+        processEffect(processed);
+    }
+    else
+    {
+        // Il ring del dry scorre anche in bypass: all'uscita la sua storia
+        // è l'ingresso recente, mai audio di prima del bypass
+        dryWetter.copyDrySignal(buffer);
+        dryWetter.skip(numSamples);
+    }
+
+    bypassDelay.process(buffer, numChannels, numSamples);
+
+    if (fadingToBypass)
+        bypassFade.process(buffer.getArrayOfWritePointers(), processed.getArrayOfReadPointers(), numChannels, numSamples);
+}
+
+bool SubSaverAudioProcessor::updateSilence(const juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        if (buffer.getMagnitude(ch, 0, numSamples) > Tail::SILENCE_THRESHOLD)
+        {
+            silentSamples = 0;
+            return false;
+        }
+    }
+
+    // Sospesa se l'ingresso era già fermo da almeno la coda della catena:
+    // anche il primo sample del blocco esce sotto soglia
+    const bool asleep = silentSamples >= tailSamples;
+    silentSamples = juce::jmin(silentSamples + numSamples, tailSamples);
+    return asleep;
+}
+
+bool SubSaverAudioProcessor::updateMonoPath(const juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    // Già un solo canale: niente da risparmiare
+    if (buffer.getNumChannels() < 2)
+        return false;
+
+    // Tutti i canali identici al canale 0 al bit (sempre, con ingresso mono)
+    // e nessun bias stereo (in mid/side, solo stereo, il bias va solo sulla
+    // mid: L e R restano uguali; negli altri layout il bias resta L/R)
+    bool identical = true;
+    if (getTotalNumInputChannels() > 1)
+    {
+        for (int ch = 1; ch < buffer.getNumChannels() && identical; ++ch)
+            identical = std::memcmp(buffer.getReadPointer(0), buffer.getReadPointer(ch), sizeof(float) * static_cast<size_t>(numSamples)) == 0;
+    }
+
+    const bool midSideBias = midSide && buffer.getNumChannels() == 2;
+    if (!identical || !(midSideBias || waveshaper.hasZeroStereoWidth()))
+    {
+        identicalSamples = 0;
+        return false;
+    }
 
-    // 1. Salva dry signal
+    // Gli stati dei canali coincidono solo dopo la coda della catena
+    // dall'ultima differenza: da lì ogni canale è una copia del canale 0
+    const bool mono = identicalSamples >= tailSamples;
+    identicalSamples = juce::jmin(identicalSamples + numSamples, tailSamples);
+    return mono;
+}
+
+void SubSaverAudioProcessor::processEffect(juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    // ═══════════════════════════════════════════════════════════
+    // CATENA SOSPESA: ingresso e code sotto -100dB. Tilt, envelope,
+    // waveshaper e disperser restano fermi (stato congelato, già
+    // decaduto); i ring dei delay continuano a scorrere, così al
+    // risveglio latenza e storia del dry sono coerenti.
+    // ═══════════════════════════════════════════════════════════
+    if (updateSilence(buffer))
+    {
+        dryWetter.copyDrySignal(buffer);
+        dryWetter.skip(numSamples);
+        buffer.clear();
+
+        if (constantLatency)
+            latencyPadding.process(buffer, juce::jmin(buffer.getNumChannels(), getTotalNumOutputChannels()), numSamples);
+        return;
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // PERCORSO MONO: canali identici, la catena elabora solo il canale
+    // 0 e lo copia in uscita. Uscendo dal mono le lane degli altri
+    // canali riprendono dallo stato del canale 0 (identico per costruzione).
+    // ═══════════════════════════════════════════════════════════
+    const bool mono = updateMonoPath(buffer);
+    const int numChannels = buffer.getNumChannels();
+
+    if (monoPath && !mono)
+    {
+        for (int ch = 1; ch < numChannels; ++ch)
+        {
+            tiltFilterPre.copyChannelState(0, ch);
+            tiltFilterPost.copyChannelState(0, ch);
+            disperser.copyChannelState(0, ch);
+        }
+    }
+
+    monoPath = mono;
+    waveshaper.setMonoShaping(mono);
+
+    juce::AudioBuffer<float> chain(buffer.getArrayOfWritePointers(), mono ? 1 : numChannels, numSamples);
+
+    // 1. Salva dry signal (tutti i canali: il ring resta valido all'uscita dal mono)
     dryWetter.copyDrySignal(buffer);
 
     // 2. TILT FILTER PRE (modifica contenuto armonico prima della distorsione)
-    tiltFilterPre.processBlock(buffer,numSamples);
+    tiltFilterPre.processBlock(chain, numSamples);
 
-    // 2. Genera envelope dal segnale (0-1)
-    envelopeFollower.processBlock(buffer, envelopeBuffer);
+    // 2. Genera envelope dal segnale (0-1). Oltre due canali la somma è
+    //    riportata a quella di una coppia stereo, così la profondità della
+    //    modulazione non cresce con il layout
+    const float channelGain = (mono ? static_cast<float>(numChannels) : 1.0f)
+                            * (numChannels > 2 ? 2.0f / static_cast<float>(numChannels) : 1.0f);
+    envelopeFollower.processBlock(chain, envelopeBuffer, channelGain);
 
-    // 3. Copia envelope nel buffer di modulazione
-    modulatedDriveBuffer.makeCopyOf(envelopeBuffer, true);
+    // 3. Applica distorsione con drive modulato dall'envelope. Gli
+    //    oversampler filtrano sempre tutti i canali, lo shaping solo il primo
+    if (mono)
+        copyFirstChannel(buffer);
 
-    // 4. Applica distorsione n drive modulato
-    waveshaper.processBlock(buffer,modulatedDriveBuffer);
+    waveshaper.processBlock(buffer, envelopeBuffer);
 
-    tiltFilterPost.processBlock(buffer,numSamples);
+    tiltFilterPost.processBlock(chain, numSamples);
     // 5. Mixa dry/wet
-    dryWetter.mergeDryAndWet(buffer);
+    dryWetter.mergeDryAndWet(chain);
+
+    // 6. Disperser (frequenza modulabile dall'envelope)
+    processDisperser(buffer, chain, mono);
+
+    // 7. Padding fino alla latenza massima (solo in modalità a latenza costante)
+    if (constantLatency)
+        latencyPadding.process(buffer, juce::jmin(buffer.getNumChannels(), getTotalNumOutputChannels()), numSamples);
+}
+
+void SubSaverAudioProcessor::processDisperser(juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& chain, bool mono)
+{
+    const int numSamples = buffer.getNumSamples();
+
+    // La cascata è lineare e uguale sui due canali: in M/S il risultato non
+    // cambia, ma la side sotto soglia si può saltare. Lo stato segue il
+    // dominio (trasformato come il segnale al cambio)
+    const bool midSideDomain = midSide && !mono && buffer.getNumChannels() == 2 && disperser.canProcessMono();
+
+    if (midSideDomain != disperserMidSide)
+    {
+        disperser.convertChannelState(midSideDomain);
+        disperserMidSide = midSideDomain;
+        quietSideSamples = 0;
+    }
+
+    if (midSideDomain)
+    {
+        MidSide::encode(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
+
+        if (updateSidePath(buffer))
+        {
+            disperser.processBlock(buffer, envelopeBuffer);
+        }
+        else
+        {
+            // Side sotto soglia: passa senza dispersione
+            juce::AudioBuffer<float> mid(buffer.getArrayOfWritePointers(), 1, numSamples);
+            disperser.processBlock(mid, envelopeBuffer);
+        }
+
+        MidSide::decode(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
+        return;
+    }
+
+    // Percorso mono: la convoluzione non ha stato copiabile e lavora
+    // sempre su tutti i canali
+    if (mono && disperser.canProcessMono())
+    {
+        disperser.processBlock(chain, envelopeBuffer);
+        copyFirstChannel(buffer);
+        return;
+    }
+
+    if (mono)
+        copyFirstChannel(buffer);
+    disperser.processBlock(buffer, envelopeBuffer);
+}
+
+bool SubSaverAudioProcessor::updateSidePath(const juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int hold = disperser.getTailSamples();
+
+    if (buffer.getMagnitude(1, 0, numSamples) > SIDE_THRESHOLD)
+    {
+        quietSideSamples = 0;
+        return true;
+    }
+
+    // Side ferma da almeno la coda del disperser: la sua lane è già decaduta
+    const bool active = quietSideSamples < hold;
+    quietSideSamples = juce::jmin(quietSideSamples + numSamples, hold);
+    return active;
+}
+
+void SubSaverAudioProcessor::copyFirstChannel(juce::AudioBuffer<float>& buffer)
+{
+    for (int ch = 1; ch < buffer.getNumChannels(); ++ch)
+        buffer.copyFrom(ch, 0, buffer, 0, 0, buffer.getNumSamples());
+}
+
+bool SubSaverAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
+{
+    // Qualsiasi layout fino a maxChannels canali (mono, stereo, 5.1,
+    // 7.1.4...), con ingresso uguale all'uscita o mono duplicato in uscita
+    const auto output = layouts.getMainOutputChannelSet();
+    const auto input = layouts.getMainInputChannelSet();
 
-	// 6. Disperser
-	disperser.processBlock(buffer);
+    if (output.isDisabled() || output.size() > Parameters::maxChannels)
+        return false;
+
+    return input == juce::AudioChannelSet::mono() || input == output;
 }
 
 //==============================================================================
@@ -94,7 +500,7 @@ int SubSaverAudioProcessor::calculateTotalLatency(double sampleRate)
     
     latency += waveshaper.getLatencySamples();
 
-    // Latenza filtri (dipende dall'ordine e tipo)
+    // Latenza filtri (0 per gli shelf IIR, riportata per coerenza)
     latency += tiltFilterPre.getLatencySamples();
     latency += tiltFilterPost.getLatencySamples();
 
@@ -103,46 +509,144 @@ int SubSaverAudioProcessor::calculateTotalLatency(double sampleRate)
     return latency;
 }
 
-void SubSaverAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+int SubSaverAudioProcessor::calculateMaxLatency()
 {
-    if (parameterID == Parameters::nameDryLevel)
-        dryWetter.setDryLevel(newValue);
-    else if (parameterID == Parameters::nameWetLevel)
-        dryWetter.setWetLevel(newValue);
-  else if (parameterID == Parameters::nameDrive) 
-        waveshaper.setDrive(newValue);
-    else if (parameterID == Parameters::nameStereoWidth) 
-        waveshaper.setStereoWidth(newValue);  
-    else if (parameterID == Parameters::nameEnvAmount)
-        envelopeFollower.setModAmount(newValue);
-    else if (parameterID == Parameters::nameTilt)
-    {
-        // Tilt PRE: usa il valore diretto
-        tiltFilterPre.setTiltAmount(newValue);
+    // Massimo ritardo del dry path: come calculateDryDelay, ma con la
+    // configurazione di oversampling più lenta
+    return waveshaper.getMaxLatencySamples()
+        + tiltFilterPre.getLatencySamples()
+        + tiltFilterPost.getLatencySamples();
+}
 
-        // Tilt POST: inverte il valore (compensa)
-        tiltFilterPost.setTiltAmount(-newValue);
-    }
-    else if (parameterID == Parameters::nameOversampling) {
-        waveshaper.setOversampling(static_cast<bool>(newValue));
-        // Ricalcola la latenza totale e aggiorna l'host
-        int newLatency = calculateTotalLatency(getSampleRate());
+int SubSaverAudioProcessor::calculateWorstCaseLatency()
+{
+    // Configurazione più lenta di ogni modulo: oversampling/ADAA, tilt, disperser
+    return calculateMaxLatency() + Disperser::getMaxLatencySamples();
+}
+
+int SubSaverAudioProcessor::calculateDryDelay()
+{
+    // Il disperser lavora dopo il mix dry/wet: la sua latenza è già
+    // comune ai due segnali e non va compensata sul dry
+    return calculateTotalLatency(getSampleRate()) - disperser.getLatencySamples();
+}
+
+void SubSaverAudioProcessor::updateLatency()
+{
+    // Prima di prepareToPlay non c'è ancora nulla da compensare
+    if (getSampleRate() <= 0.0)
+        return;
+
+    // Ricalcola la latenza totale e aggiorna l'host solo se è cambiata.
+    // A latenza costante il valore riportato non cambia: cambia solo il
+    // padding in uscita (con crossfade, come i moduli)
+    const int processingLatency = calculateTotalLatency(getSampleRate());
+    const int newLatency = constantLatency ? calculateWorstCaseLatency() : processingLatency;
+    if (newLatency != getLatencySamples())
         setLatencySamples(newLatency);
 
-        // Aggiorna anche il dryWetter con la nuova latenza
-        dryWetter.setDelaySamples(newLatency);
-    
-    }
-    else if (parameterID == Parameters::nameMorph) {
-        waveshaper.setMorphValue(newValue);  // Ora passa direttamente il float 0.0-3.0
+    latencyPadding.setDelaySamples(newLatency - processingLatency);
+
+    // Il dry del bypass si sente solo in bypass o durante il crossfade:
+    // altrimenti il ritardo cambia subito e il bypass parte già allineato
+    bypassDelay.setDelaySamples(newLatency, bypassed || bypassFade.isActive());
+
+    // Aggiorna anche il dryWetter (solo la latenza prima del mix)
+    const int dryDelay = calculateDryDelay();
+    if (dryDelay != dryWetter.getDelaySamples())
+        dryWetter.setDelaySamples(dryDelay);
+}
+
+int SubSaverAudioProcessor::calculateTailSamples()
+{
+    // Moduli in serie: le code si sommano, più la latenza riportata
+    return getLatencySamples()
+        + tiltFilterPre.getTailSamples()
+        + waveshaper.getTailSamples()
+        + tiltFilterPost.getTailSamples()
+        + disperser.getTailSamples();
+}
+
+double SubSaverAudioProcessor::getTailLengthSeconds() const
+{
+    return tailLengthSeconds.load();
+}
+
+void SubSaverAudioProcessor::syncParameters()
+{
+    const auto& values = parameterValues;
+
+    dryWetter.setDryLevel(values.dryLevel->load());
+    dryWetter.setWetLevel(values.wetLevel->load());
+    waveshaper.setDrive(values.drive->load());
+    waveshaper.setStereoWidth(values.stereoWidth->load());
+    waveshaper.setMorphValue(values.morph->load());
+    envelopeFollower.setModAmount(values.envAmount->load());
+
+    // Tilt PRE usa il valore diretto, POST lo inverte (compensa)
+    const float tilt = values.tilt->load();
+    tiltFilterPre.setTiltAmount(tilt);
+    tiltFilterPost.setTiltAmount(-tilt);
+
+    // Configurazione oversampling: il cambio avviene al prossimo processBlock
+    waveshaper.setOversampling(values.oversampling->load() > 0.5f);
+    waveshaper.setOversamplingFactor(static_cast<int>(values.oversamplingFactor->load()));
+    waveshaper.setOversamplingFilter(static_cast<int>(values.oversamplingFilter->load()));
+    waveshaper.setOfflineOversamplingFactor(static_cast<int>(values.offlineOversamplingFactor->load()));
+    waveshaper.setOfflineOversamplingFilter(static_cast<int>(values.offlineOversamplingFilter->load()));
+    waveshaper.setAntiAliasing(static_cast<int>(values.antiAliasing->load()));
+    waveshaper.setNonRealtime(isNonRealtime());
+
+    // Disperser: i setter segnano le modifiche, il ricalcolo avviene una
+    // sola volta all'inizio del suo processBlock
+    disperser.setAmount(values.disperserAmount->load());
+    disperser.setFrequency(values.disperserFreq->load());
+    disperser.setPinch(values.disperserPinch->load());
+    disperser.setNumStages(static_cast<int>(values.disperserStages->load()));
+    disperser.setEnvModAmount(values.disperserEnvMod->load());
+    disperser.setMode(static_cast<int>(values.disperserMode->load()));
+
+    // Mid/side: lo shaping cambia dominio al prossimo blocco
+    midSide = values.midSide->load() > 0.5f;
+    waveshaper.setMidSide(midSide);
+
+    // Multithread: lavoro per canale sul pool (envelope e oversampler
+    // restano sull'audio thread, l'envelope è calcolato prima dello shaping).
+    // Il pool è usato solo se già avviato: accendendo la modalità durante il
+    // playback lo avvia il message thread, nel frattempo tutto resta in serie.
+    // Spegnendola i worker restano fermi sul loro evento fino a releaseResources
+    const bool useWorkers = values.multithread->load() > 0.5f;
+    if (useWorkers && !workerPool.isStarted())
+        triggerAsyncUpdate();
+
+    auto* pool = useWorkers && workerPool.isStarted() ? &workerPool : nullptr;
+    waveshaper.setWorkerPool(pool);
+    tiltFilterPre.setWorkerPool(pool);
+    tiltFilterPost.setWorkerPool(pool);
+    disperser.setWorkerPool(pool);
+
+    // Attivando la latenza costante il padding riparte da una storia vuota
+    const bool shouldUseConstantLatency = values.constantLatency->load() > 0.5f;
+    if (shouldUseConstantLatency != constantLatency)
+    {
+        constantLatency = shouldUseConstantLatency;
+        latencyPadding.reset();
     }
-    else if (parameterID == Parameters::nameDisperserAmount)
-        disperser.setAmount(newValue);
-    else if (parameterID == Parameters::nameDisperserFreq)
-        disperser.setFrequency(newValue);
-    else if (parameterID == Parameters::nameDisperserPinch)
-        disperser.setPinch(newValue);
+}
 
+void SubSaverAudioProcessor::startWorkerPool()
+{
+    // Un worker per canale oltre il primo (l'audio thread fa la sua parte),
+    // nei limiti dei core
+    workerPool.start(juce::jmin(juce::SystemStats::getNumCpus() - 1, getTotalNumOutputChannels() - 1));
+}
+
+void SubSaverAudioProcessor::handleAsyncUpdate()
+{
+    // Multithread acceso durante il playback: l'audio thread non usa il
+    // pool finché isStarted() è falso, avviarlo qui è sicuro
+    if (parameterValues.multithread->load() > 0.5f && !workerPool.isStarted())
+        startWorkerPool();
 }
 
 
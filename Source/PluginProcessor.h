@@ -8,10 +8,12 @@
 #include "EnvelopeFollower.h"
 #include "Filters.h"
 #include "Disperser.h"
+#include "WorkerPool.h"
 //==============================================================================
 
 
-class SubSaverAudioProcessor : public AbstractProcessor
+class SubSaverAudioProcessor : public AbstractProcessor,
+    private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -22,11 +24,21 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+    bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
 
     int calculateTotalLatency(double sampleRate);
+    int calculateMaxLatency();
+    int calculateWorstCaseLatency();
+    int calculateDryDelay();
+
+    int calculateTailSamples();
+
+    double getTailLengthSeconds() const override;
 
     bool hasEditor() const override {
         return true; // (change this to false if you choose to not supply an editor)
@@ -37,20 +49,81 @@ public:
     void getStateInformation(MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
-
     juce::AudioProcessorValueTreeState parameters;
 
 
 private:
+    void syncParameters();
+    void startWorkerPool();
+    void handleAsyncUpdate() override;
+    void updateLatency();
+    void processInChunks(juce::AudioBuffer<float>& buffer, void (SubSaverAudioProcessor::*processFunction)(juce::AudioBuffer<float>&));
+    void processChunk(juce::AudioBuffer<float>& buffer);
+    void processBypassedChunk(juce::AudioBuffer<float>& buffer);
+    void processEffect(juce::AudioBuffer<float>& buffer);
+    bool updateSilence(const juce::AudioBuffer<float>& buffer);
+    bool updateMonoPath(const juce::AudioBuffer<float>& buffer);
+    static void copyFirstChannel(juce::AudioBuffer<float>& buffer);
+    void processDisperser(juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>& chain, bool mono);
+    bool updateSidePath(const juce::AudioBuffer<float>& buffer);
+
+    // Valori dei parametri: atomici dell'APVTS letti una volta per blocco
+    // da syncParameters (niente listener né confronti di stringhe)
+    struct ParameterValues
+    {
+        explicit ParameterValues(juce::AudioProcessorValueTreeState& apvts);
+
+        std::atomic<float>* dryLevel;
+        std::atomic<float>* wetLevel;
+        std::atomic<float>* drive;
+        std::atomic<float>* stereoWidth;
+        std::atomic<float>* envAmount;
+        std::atomic<float>* tilt;
+        std::atomic<float>* oversampling;
+        std::atomic<float>* oversamplingFactor;
+        std::atomic<float>* oversamplingFilter;
+        std::atomic<float>* offlineOversamplingFactor;
+        std::atomic<float>* offlineOversamplingFilter;
+        std::atomic<float>* disperserAmount;
+        std::atomic<float>* disperserFreq;
+        std::atomic<float>* disperserPinch;
+        std::atomic<float>* disperserStages;
+        std::atomic<float>* disperserMode;
+        std::atomic<float>* disperserEnvMod;
+        std::atomic<float>* morph;
+        std::atomic<float>* antiAliasing;
+        std::atomic<float>* constantLatency;
+        std::atomic<float>* bypass;
+        std::atomic<float>* midSide;
+        std::atomic<float>* multithread;
+    };
+
+    ParameterValues parameterValues;
+    WorkerPool workerPool;                         // Avviato solo in modalità Multithread (startWorkerPool)
     DryWet dryWetter;
     WaveshaperCore waveshaper;
     EnvelopeFollower envelopeFollower;
     TiltFilter tiltFilterPre;  
     TiltFilter tiltFilterPost;  
     Disperser disperser;
-    juce::AudioBuffer<double> envelopeBuffer;      // Envelope grezzo (0-1)
-    juce::AudioBuffer<double> modulatedDriveBuffer; // Drive modulato
+    juce::AudioBuffer<float> envelopeBuffer;       // Envelope grezzo (0-1)
+    CompensationDelay latencyPadding;              // Porta l'uscita alla latenza massima
+    bool constantLatency = Parameters::defaultConstantLatency;
+    static constexpr int BYPASS_CROSSFADE_SAMPLES = 256;   // ~5ms @ 48kHz
+    CompensationDelay bypassDelay;                 // Dry alla latenza riportata, per il bypass
+    Crossfade bypassFade { BYPASS_CROSSFADE_SAMPLES };
+    juce::AudioBuffer<float> bypassSignal;         // Percorso uscente durante il crossfade di bypass
+    bool bypassed = false;
+    int silentSamples = 0;                         // Sample consecutivi di silenzio in ingresso
+    int identicalSamples = 0;                      // Sample consecutivi con L e R identici
+    bool monoPath = false;                         // Catena su un solo canale nell'ultimo blocco
+    bool midSide = Parameters::defaultMidSide;
+    bool disperserMidSide = false;                 // Dominio dello stato della cascata
+    int quietSideSamples = 0;                      // Sample consecutivi con side sotto soglia
+    static constexpr float SIDE_THRESHOLD = 3.1623e-5f;   // -90dB
+    int tailSamples = 0;                           // Latenza + code dei moduli
+    std::atomic<double> tailLengthSeconds { 0.0 }; // Letto dall'host sul message thread
+    int preparedBlockSize = 0;                      // Blocco massimo dichiarato in prepareToPlay
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SubSaverAudioProcessor)
 };
 
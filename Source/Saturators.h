@@ -2,8 +2,10 @@
 
 #include <JuceHeader.h>
 #include "PluginParameters.h"
-
-#define TARGET_SAMPLING_RATE 192000.0
+#include "WaveshapeTables.h"
+#include "Filters.h"
+#include "Crossfade.h"
+#include "MidSide.h"
 
 // ═══════════════════════════════════════════════════════════════
 // ENUM per i tipi di distorsione (shape mode)
@@ -16,6 +18,573 @@ enum class WaveshapeType
     Foldback = 3     // C: Foldback classico (hard clipping piegato)
 };
 
+// ═══════════════════════════════════════════════════════════════
+// WAVESHAPE SIMD - kernel vettoriali delle forme
+// Processano SIMDFloat::size() campioni alla volta (4 con SSE/NEON,
+// 8 con AVX). sin/tanh sono sostituiti da approssimazioni
+// polinomiali/razionali vettorizzabili (errore < 1e-5 su tutto il
+// range di drive * env). Condivisi da WaveshaperCore (shaping
+// diretto) e ADAAShaper (ADAA di primo ordine).
+// ═══════════════════════════════════════════════════════════════
+struct WaveshapeSIMD
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    using SIMDMask = SIMDFloat::vMaskType;
+
+    static constexpr float TANH_CLAMP = 7.90531110763549805f;
+
+    static SIMDFloat floorSIMD(SIMDFloat x)
+    {
+        // truncate arrotonda verso zero: correggi di -1 dove x è negativo e non intero
+        auto truncated = SIMDFloat::truncate(x);
+        return truncated - (SIMDFloat::expand(1.0f) & SIMDFloat::greaterThan(truncated, x));
+    }
+
+    // mask ? a : b per lane (selezione a bit: NaN/inf della lane scartata non passano)
+    static SIMDFloat selectSIMD(SIMDMask mask, SIMDFloat a, SIMDFloat b)
+    {
+        return (a & mask) + (b & ~mask);
+    }
+
+    // SIMDRegister non ha la divisione: 1/x calcolato per lane
+    static SIMDFloat reciprocalSIMD(SIMDFloat x)
+    {
+        alignas(sizeof(SIMDFloat)) float lanes[SIMDFloat::SIMDNumElements];
+        x.copyToRawArray(lanes);
+        for (auto& lane : lanes)
+            lane = 1.0f / lane;
+
+        return SIMDFloat::fromRawArray(lanes);
+    }
+
+    // sin(2*pi*x): riduzione a r in [-0.5, 0.5], poi folding simmetrico
+    // su [-0.25, 0.25] e polinomio di Taylor dispari di grado 11
+    static SIMDFloat sineFoldSIMD(SIMDFloat x)
+    {
+        auto r = x - floorSIMD(x + 0.5f);
+        auto v = SIMDFloat::max(SIMDFloat::min(r, SIMDFloat::expand(0.5f) - r),
+                                SIMDFloat::expand(-0.5f) - r);
+
+        auto t = v * juce::MathConstants<float>::twoPi;
+        auto t2 = t * t;
+        auto p = t2 * -2.5052108e-8f + 2.7557319e-6f;
+        p = p * t2 - 1.9841270e-4f;
+        p = p * t2 + 8.3333333e-3f;
+        p = p * t2 - 1.6666667e-1f;
+        p = p * t2 + 1.0f;
+        return t * p;
+    }
+
+    // tanh razionale 13/6 (Eigen generic_fast_tanh_float): restituisce
+    // tanh(x) / x, con x già limitato a ±TANH_CLAMP
+    static SIMDFloat tanhRatioSIMD(SIMDFloat x)
+    {
+        auto x2 = x * x;
+        auto p = x2 * -2.76076847742355e-16f + 2.00018790482477e-13f;
+        p = p * x2 - 8.60467152213735e-11f;
+        p = p * x2 + 5.12229709037114e-08f;
+        p = p * x2 + 1.48572235717979e-05f;
+        p = p * x2 + 6.37261928875436e-04f;
+        p = p * x2 + 4.89352455891786e-03f;
+
+        auto q = x2 * 1.19825839466702e-06f + 1.18534705686654e-04f;
+        q = q * x2 + 2.26843463243900e-03f;
+        q = q * x2 + 4.89352518554385e-03f;
+
+        return p * reciprocalSIMD(q);
+    }
+
+    static SIMDFloat clampTanhSIMD(SIMDFloat x)
+    {
+        return SIMDFloat::max(SIMDFloat::min(x, SIMDFloat::expand(TANH_CLAMP)), SIMDFloat::expand(-TANH_CLAMP));
+    }
+
+    // tanh, precisione float su [-7.9, 7.9] (oltre è ±1 in float)
+    static SIMDFloat tanhSIMD(SIMDFloat x)
+    {
+        x = clampTanhSIMD(x);
+        return x * tanhRatioSIMD(x);
+    }
+
+    // tanh(x) / x, definita anche in x = 0
+    static SIMDFloat tanhOverXSIMD(SIMDFloat x)
+    {
+        const auto ax = SIMDFloat::abs(x);
+        const auto saturated = SIMDFloat::greaterThan(ax, SIMDFloat::expand(TANH_CLAMP));
+        return selectSIMD(saturated,
+                          reciprocalSIMD(SIMDFloat::max(ax, SIMDFloat::expand(TANH_CLAMP))),
+                          tanhRatioSIMD(clampTanhSIMD(x)));
+    }
+
+    // sin(pi*x) / (pi*x): serie di Taylor vicino a 0, sineFoldSIMD altrove
+    static SIMDFloat sincPiSIMD(SIMDFloat x)
+    {
+        const auto one = SIMDFloat::expand(1.0f);
+        const auto z = x * juce::MathConstants<float>::pi;
+        const auto z2 = z * z;
+
+        auto series = z2 * 2.7557319e-6f - 1.9841270e-4f;
+        series = series * z2 + 8.3333333e-3f;
+        series = series * z2 - 1.6666667e-1f;
+        series = series * z2 + 1.0f;
+
+        const auto small = SIMDFloat::lessThan(SIMDFloat::abs(z), one);
+        const auto direct = sineFoldSIMD(x * 0.5f) * reciprocalSIMD(selectSIMD(small, one, z));
+        return selectSIMD(small, series, direct);
+    }
+
+    // ln(1 + r) / r per r in [-0.5, 1], definita anche in r = 0:
+    // ln(1 + r) = 2 atanh(z), z = r / (2 + r) in [-1/3, 1/3]
+    static SIMDFloat log1pOverXSIMD(SIMDFloat r)
+    {
+        const auto inverse = reciprocalSIMD(r + 2.0f);
+        const auto z = r * inverse;
+        const auto z2 = z * z;
+
+        auto series = z2 * (1.0f / 13.0f) + (1.0f / 11.0f);
+        series = series * z2 + (1.0f / 9.0f);
+        series = series * z2 + (1.0f / 7.0f);
+        series = series * z2 + (1.0f / 5.0f);
+        series = series * z2 + (1.0f / 3.0f);
+        series = series * z2 + 1.0f;
+        return inverse * series * 2.0f;
+    }
+
+    static SIMDFloat chebyshevPolySIMD(SIMDFloat x)
+    {
+        auto t = tanhSIMD(x);
+        return t * 3.0f - t * t * t * 4.0f;
+    }
+
+    static SIMDFloat triangleWavefolderSIMD(SIMDFloat x)
+    {
+        auto phase = x + 0.25f;
+        return SIMDFloat::abs(phase - floorSIMD(phase + 0.5f)) * 4.0f - 1.0f;
+    }
+
+    static SIMDFloat foldbackSIMD(SIMDFloat x)
+    {
+        // Stessa forma chiusa di foldback(): 1 - |4 * frac(2x + 0.25) - 2|
+        auto v = x * 2.0f + 0.25f;
+        return SIMDFloat::expand(1.0f) - SIMDFloat::abs((v - floorSIMD(v)) * 4.0f - 2.0f);
+    }
+
+    template <int Shape>
+    static SIMDFloat shapeSIMD(SIMDFloat x)
+    {
+        if constexpr (Shape == 0)
+            return chebyshevPolySIMD(x);
+        else if constexpr (Shape == 1)
+            return sineFoldSIMD(x);
+        else if constexpr (Shape == 2)
+            return triangleWavefolderSIMD(x);
+        else
+            return foldbackSIMD(x);
+    }
+};
+
+// ═══════════════════════════════════════════════════════════════
+// ADAA SHAPER - Antiderivative Anti-Aliasing (1° e 2° ordine)
+// Paper: Parker, Zavalishin, Le Bivic - "Reducing the aliasing of
+//        nonlinear waveshaping using continuous-time convolution" (DAFx-16)
+//
+// Primo ordine:   y[n] = (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1])
+// Secondo ordine: y[n] = 2 / (x[n] - x[n-2]) * (D1[n] - D1[n-1]),
+//                 D1[n] = (F2(x[n]) - F2(x[n-1])) / (x[n] - x[n-1])
+//
+// Ritardo introdotto: 0.5 sample (1° ordine), 1 sample (2° ordine)
+// alla frequenza di processing. Il morph tra due forme è lineare,
+// quindi si applica l'ADAA ad ogni forma e si miscelano le uscite.
+//
+// Il primo ordine è vettoriale in float: l'uscita è la media di F0
+// su [x[n-1], x[n]], calcolata in forma chiusa per ogni forma così da
+// non sottrarre antiderivate quasi uguali (cancellazione in float).
+// Il secondo ordine resta scalare in double: la sua differenza seconda
+// perde ~eps * |F2| / dx² e in float sarebbe inutilizzabile.
+// ═══════════════════════════════════════════════════════════════
+class ADAAShaper
+{
+public:
+    static constexpr int NUM_SHAPES = 4;
+
+    ADAAShaper() { reset(); }
+
+    void reset()
+    {
+        x1 = x2 = 0.0;
+        validShapes = 0;
+    }
+
+    // Ritardo di gruppo introdotto (in sample alla frequenza di processing)
+    static double getDelaySamples(int order)
+    {
+        return order >= 2 ? 1.0 : (order == 1 ? 0.5 : 0.0);
+    }
+
+    /**
+     * Processa in-place un buffer di campioni già "driven"
+     * data, morph e scratch devono essere allineati e paddati a multipli
+     * di SIMDFloat::size() (come per lo shaping diretto).
+     * @param scratch buffer di lavoro di almeno numSamples campioni
+     * @param order   1 o 2
+     */
+    void process(float* data, const float* morph, float* scratch, size_t numSamples, int order)
+    {
+        if (order == 1)
+            processFirstOrder(data, morph, scratch, numSamples);
+        else
+            processSecondOrder(data, morph, numSamples);
+    }
+
+private:
+    using SIMDFloat = WaveshapeSIMD::SIMDFloat;
+
+    static constexpr double TOL = 1.0e-5;
+
+    // ───────────────────────────────────────────────────────────
+    // Primo ordine (SIMD, float)
+    // ───────────────────────────────────────────────────────────
+    void processFirstOrder(float* data, const float* morph, float* previous, size_t numSamples)
+    {
+        if (numSamples == 0)
+            return;
+
+        // x[n-1] allineato a x[n]: la forma chiusa non ha altro stato
+        previous[0] = static_cast<float>(x1);
+        juce::FloatVectorOperations::copy(previous + 1, data, static_cast<int>(numSamples) - 1);
+
+        x2 = numSamples > 1 ? data[numSamples - 2] : x1;
+        x1 = data[numSamples - 1];
+        validShapes = 0;  // il secondo ordine riparte comunque da reset()
+
+        // Solo le forme toccate dal morph nel blocco
+        const auto range = juce::FloatVectorOperations::findMinAndMax(morph, static_cast<int>(numSamples));
+        const int first = juce::jlimit(0, NUM_SHAPES - 1, static_cast<int>(std::floor(range.getStart())));
+        const int last = juce::jlimit(0, NUM_SHAPES - 1, static_cast<int>(std::ceil(range.getEnd())));
+
+        if (first == last)
+        {
+            switch (first)
+            {
+                case 0:  processFirstOrderSIMD<0, 0>(data, previous, morph, numSamples); break;
+                case 1:  processFirstOrderSIMD<1, 1>(data, previous, morph, numSamples); break;
+                case 2:  processFirstOrderSIMD<2, 2>(data, previous, morph, numSamples); break;
+                default: processFirstOrderSIMD<3, 3>(data, previous, morph, numSamples); break;
+            }
+        }
+        else if (last == first + 1)
+        {
+            switch (first)
+            {
+                case 0:  processFirstOrderSIMD<0, 1>(data, previous, morph, numSamples); break;
+                case 1:  processFirstOrderSIMD<1, 2>(data, previous, morph, numSamples); break;
+                default: processFirstOrderSIMD<2, 3>(data, previous, morph, numSamples); break;
+            }
+        }
+        else
+        {
+            processFirstOrderSIMD<0, NUM_SHAPES - 1>(data, previous, morph, numSamples);
+        }
+    }
+
+    template <int FirstShape, int LastShape>
+    static void processFirstOrderSIMD(float* data, const float* previous, const float* morph, size_t numSamples)
+    {
+        for (size_t i = 0; i < numSamples; i += SIMDFloat::size())
+        {
+            const auto x = SIMDFloat::fromRawArray(data + i);
+            const auto xPrev = SIMDFloat::fromRawArray(previous + i);
+            const auto m = SIMDFloat::fromRawArray(morph + i);
+
+            blendFirstOrderSIMD<FirstShape, LastShape>(x, xPrev, m).copyToRawArray(data + i);
+        }
+    }
+
+    // Somma delle forme First..Last pesate max(0, 1 - |morph - k|)
+    template <int Shape, int LastShape>
+    static SIMDFloat blendFirstOrderSIMD(SIMDFloat x, SIMDFloat xPrev, SIMDFloat m)
+    {
+        const auto weight = SIMDFloat::max(SIMDFloat::expand(0.0f),
+                                           SIMDFloat::expand(1.0f) - SIMDFloat::abs(m - static_cast<float>(Shape)));
+        auto y = firstOrderSIMD<Shape>(x, xPrev) * weight;
+
+        if constexpr (Shape < LastShape)
+            y += blendFirstOrderSIMD<Shape + 1, LastShape>(x, xPrev, m);
+
+        return y;
+    }
+
+    template <int Shape>
+    static SIMDFloat firstOrderSIMD(SIMDFloat x, SIMDFloat xPrev)
+    {
+        if constexpr (Shape == 0)
+            return chebyshevFirstOrderSIMD(x, xPrev);
+        else if constexpr (Shape == 1)
+            return sineFoldFirstOrderSIMD(x, xPrev);
+        else
+            return piecewiseFirstOrderSIMD<Shape>(x, xPrev);
+    }
+
+    // Media di 3t - 4t³ (t = tanh) su [xPrev, x]; F1 = 2t² - ln cosh(x),
+    // con -ln cosh(x) = ln(1 + |t|) - |x|
+    static SIMDFloat chebyshevFirstOrderSIMD(SIMDFloat x, SIMDFloat xPrev)
+    {
+        using K = WaveshapeSIMD;
+        const auto one = SIMDFloat::expand(1.0f);
+        const auto zero = SIMDFloat::expand(0.0f);
+
+        const auto t = K::tanhSIMD(x);
+        const auto tPrev = K::tanhSIMD(xPrev);
+        const auto dx = x - xPrev;
+
+        // (t - tPrev) / dx = tanh(dx) / dx * (1 - t * tPrev)
+        const auto tanhSlope = K::tanhOverXSIMD(dx) * (one - t * tPrev);
+        const auto squareTerm = (t + tPrev) * tanhSlope * 2.0f;
+
+        const auto at = SIMDFloat::abs(t);
+        const auto atPrev = SIMDFloat::abs(tPrev);
+        const auto sameSign = SIMDFloat::greaterThanOrEqual(x * xPrev, zero);
+        const auto sum = x + xPrev;
+        const auto sign = (one & SIMDFloat::greaterThan(sum, zero)) - (one & SIMDFloat::lessThan(sum, zero));
+
+        // Stesso segno: (|x| - |xPrev|) / dx = sign e
+        // ln(1 + |t|) - ln(1 + |tPrev|) = ln(1 + r), r = sign * (t - tPrev) / (1 + |tPrev|)
+        const auto rOverDx = sign * tanhSlope * K::reciprocalSIMD(one + atPrev);
+        const auto sameSignTerm = K::log1pOverXSIMD(rOverDx * dx) * rOverDx - sign;
+
+        // Caso comune: nessuna lane attraversa lo zero
+        if ((~sameSign) == 0)
+            return squareTerm + sameSignTerm;
+
+        // Segni opposti: |dx| = |x| + |xPrev|, la differenza diretta è ben condizionata
+        const auto oppositeTerm = (at * K::log1pOverXSIMD(at) - atPrev * K::log1pOverXSIMD(atPrev)
+                                   - SIMDFloat::abs(x) + SIMDFloat::abs(xPrev))
+                                * K::reciprocalSIMD(K::selectSIMD(sameSign, one, dx));
+
+        return squareTerm + K::selectSIMD(sameSign, sameSignTerm, oppositeTerm);
+    }
+
+    // Media di sin(2 pi x) su [xPrev, x] = sin(2 pi mid) * sinc(pi dx)
+    static SIMDFloat sineFoldFirstOrderSIMD(SIMDFloat x, SIMDFloat xPrev)
+    {
+        return WaveshapeSIMD::sineFoldSIMD((x + xPrev) * 0.5f) * WaveshapeSIMD::sincPiSIMD(x - xPrev);
+    }
+
+    // Triangle e Foldback sono lineari a tratti: senza spigoli in
+    // [xPrev, x] la media è F0(mid), con uno spigolo k è la media pesata
+    // dei due tratti; oltre un tratto intero la differenza di F1 non
+    // soffre di cancellazione (|dx| >= passo)
+    template <int Shape>
+    static SIMDFloat piecewiseFirstOrderSIMD(SIMDFloat x, SIMDFloat xPrev)
+    {
+        using K = WaveshapeSIMD;
+        constexpr float kinkSpacing = Shape == 2 ? 0.5f : 0.25f;   // spigoli in -spacing/2 + k * spacing
+        constexpr float kinkOffset = -0.5f * kinkSpacing;
+        const auto one = SIMDFloat::expand(1.0f);
+
+        const auto dx = x - xPrev;
+        const auto mid = (x + xPrev) * 0.5f;
+        const auto lo = SIMDFloat::min(x, xPrev);
+        const auto hi = SIMDFloat::max(x, xPrev);
+        const auto width = hi - lo;
+
+        const auto kink = K::floorSIMD((mid - kinkOffset) * (1.0f / kinkSpacing) + 0.5f) * kinkSpacing + kinkOffset;
+        const auto wide = SIMDFloat::greaterThanOrEqual(width, SIMDFloat::expand(kinkSpacing));
+        const auto straddles = SIMDFloat::greaterThan(kink, lo) & SIMDFloat::lessThan(kink, hi);
+
+        // Caso comune: nessuna lane attraversa uno spigolo
+        if ((wide | straddles) == 0)
+            return K::shapeSIMD<Shape>(mid);
+
+        // Un solo reciproco per entrambi i casi che dividono per |dx|
+        const auto inverseWidth = K::reciprocalSIMD(K::selectSIMD(wide | straddles, width, one));
+
+        const auto wideY = (linearF1SIMD<Shape>(hi) - linearF1SIMD<Shape>(lo)) * inverseWidth;
+        const auto splitY = ((kink - lo) * K::shapeSIMD<Shape>((lo + kink) * 0.5f)
+                             + (hi - kink) * K::shapeSIMD<Shape>((kink + hi) * 0.5f)) * inverseWidth;
+
+        const auto narrowY = K::selectSIMD(straddles, splitY, K::shapeSIMD<Shape>(mid));
+        return K::selectSIMD(wide, wideY, narrowY);
+    }
+
+    // F1 di Triangle (2) e Foldback (3), stesse formule di shapeF1
+    template <int Shape>
+    static SIMDFloat linearF1SIMD(SIMDFloat x)
+    {
+        using K = WaveshapeSIMD;
+
+        if constexpr (Shape == 2)
+        {
+            const auto phase = x + 0.25f;
+            const auto u = phase - K::floorSIMD(phase + 0.5f);
+            return u * SIMDFloat::abs(u) * 2.0f - u;
+        }
+        else
+        {
+            const auto v = x * 2.0f + 0.25f;
+            const auto w = (v - K::floorSIMD(v)) * 4.0f - 2.0f;
+            return (w - w * SIMDFloat::abs(w) * 0.5f) * 0.125f;
+        }
+    }
+
+    // ───────────────────────────────────────────────────────────
+    // Secondo ordine (scalare, double)
+    // ───────────────────────────────────────────────────────────
+    void processSecondOrder(float* data, const float* morph, size_t numSamples)
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const double x = data[i];
+            const float m = morph[i];
+            const int segment = juce::jlimit(0, 2, static_cast<int>(m));
+            const double blend = m - static_cast<float>(segment);
+
+            unsigned int computedShapes = 0;
+            double y = 0.0;
+
+            if (blend < 1.0)
+            {
+                y += (1.0 - blend) * processShape(segment, x);
+                computedShapes |= 1u << segment;
+            }
+            if (blend > 0.0)
+            {
+                y += blend * processShape(segment + 1, x);
+                computedShapes |= 1u << (segment + 1);
+            }
+
+            // Le forme non calcolate ora avranno stato non valido al prossimo sample
+            validShapes = computedShapes;
+            x2 = x1;
+            x1 = x;
+
+            data[i] = static_cast<float>(y);
+        }
+    }
+
+    // ───────────────────────────────────────────────────────────
+    // Funzioni e antiderivate (double per evitare cancellazione)
+    // ───────────────────────────────────────────────────────────
+    static double triangleU(double x)
+    {
+        const double phase = x + 0.25;
+        return phase - std::floor(phase + 0.5);  // [-0.5, 0.5)
+    }
+
+    static double foldbackW(double x)
+    {
+        // foldback a soglia 0.125 = onda triangolare di periodo 0.5
+        const double v = 2.0 * x + 0.25;
+        return 4.0 * (v - std::floor(v)) - 2.0;  // [-2, 2)
+    }
+
+    static double shapeF0(int shape, double x)
+    {
+        switch (shape)
+        {
+            case 0:  { const double t = std::tanh(x); return 3.0 * t - 4.0 * t * t * t; }
+            case 1:  return std::sin(juce::MathConstants<double>::twoPi * x);
+            case 2:  return 4.0 * std::abs(triangleU(x)) - 1.0;
+            default: return 1.0 - std::abs(foldbackW(x));
+        }
+    }
+
+    static double shapeF1(int shape, double x)
+    {
+        switch (shape)
+        {
+            case 0:  { const double t = std::tanh(x); return 2.0 * t * t - WaveshapeTables::logCosh(x); }
+            case 1:  return -std::cos(juce::MathConstants<double>::twoPi * x) / juce::MathConstants<double>::twoPi;
+            case 2:  { const double u = triangleU(x); return 2.0 * u * std::abs(u) - u; }
+            default: { const double w = foldbackW(x); return 0.125 * (w - 0.5 * w * std::abs(w)); }
+        }
+    }
+
+    static double shapeF2(int shape, double x)
+    {
+        switch (shape)
+        {
+            case 0:
+                return 2.0 * (x - std::tanh(x)) - WaveshapeTables::getInstance().logCoshIntegral(x);
+            case 1:
+            {
+                constexpr double twoPi = juce::MathConstants<double>::twoPi;
+                return -std::sin(twoPi * x) / (twoPi * twoPi);
+            }
+            case 2:
+            {
+                const double u = triangleU(x);
+                const double au = std::abs(u);
+                return (2.0 / 3.0) * au * au * au - 0.5 * u * u;
+            }
+            default:
+            {
+                const double w = foldbackW(x);
+                const double aw = std::abs(w);
+                return 0.015625 * (0.5 * w * w - aw * aw * aw / 6.0);
+            }
+        }
+    }
+
+    // ───────────────────────────────────────────────────────────
+    // ADAA di secondo ordine per singola forma
+    // ───────────────────────────────────────────────────────────
+    double processShape(int shape, double x)
+    {
+        auto& state = shapeStates[shape];
+        const bool isValid = (validShapes & (1u << shape)) != 0;
+
+        if (!isValid)
+        {
+            // Ricostruisci lo stato della forma dagli ingressi precedenti
+            const double ad2X2 = shapeF2(shape, x2);
+            state.ad2X1 = shapeF2(shape, x1);
+            state.d1 = firstDifference(shape, x1, x2, state.ad2X1, ad2X2);
+        }
+
+        const double ad2 = shapeF2(shape, x);
+        const double d1 = firstDifference(shape, x, x1, ad2, state.ad2X1);
+        const double diff = x - x2;
+
+        double y;
+        if (std::abs(diff) < TOL)
+        {
+            const double xBar = 0.5 * (x + x2);
+            const double delta = xBar - x1;
+            y = (std::abs(delta) < TOL)
+                ? shapeF0(shape, 0.5 * (xBar + x1))
+                : (2.0 / delta) * (shapeF1(shape, xBar) + (state.ad2X1 - shapeF2(shape, xBar)) / delta);
+        }
+        else
+        {
+            y = 2.0 * (d1 - state.d1) / diff;
+        }
+
+        state.ad2X1 = ad2;
+        state.d1 = d1;
+        return y;
+    }
+
+    static double firstDifference(int shape, double xa, double xb, double ad2A, double ad2B)
+    {
+        const double diff = xa - xb;
+        return (std::abs(diff) < TOL)
+            ? shapeF1(shape, 0.5 * (xa + xb))
+            : (ad2A - ad2B) / diff;
+    }
+
+    struct ShapeState
+    {
+        double ad2X1 = 0.0;  // F2(x[n-1])
+        double d1 = 0.0;     // D1[n-1]
+    };
+
+    ShapeState shapeStates[NUM_SHAPES];
+    unsigned int validShapes = 0;
+    double x1 = 0.0;
+    double x2 = 0.0;
+};
+
 // ═══════════════════════════════════════════════════════════════
 // WAVESHAPER CORE - Classe unificata modulare
 // ═══════════════════════════════════════════════════════════════
@@ -42,16 +611,26 @@ public:
         stereoWidth.reset(sampleRate, 0.03);
         morphValue.reset(sampleRate, 0.25);  // 250ms smoothing
 
-        // DC blocker (HPF 5-7.5Hz)
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 7.5);
-        for (int ch = 0; ch < 2; ++ch)
-        {
-            dcBlocker[ch].coefficients = coeffs;
-            dcBlocker[ch].reset();
-        }
+        for (auto& shaper : adaaShapers)
+            shaper.reset();
+
+        // DC blocker (HPF 5-7.5Hz); la sezione di allineamento ADAA è
+        // impostata da initOversamplers con la configurazione attiva
+        dcBlocker.setSection(0, *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, DC_BLOCKER_FREQUENCY));
+        dcBlocker.reset();
 
         maxSamplesPerBlock = samplesPerBlock;
         originalSampleRate = sampleRate;
+        autoFactorIndex = getAutoFactorIndex(sampleRate);
+        if (autoFactor)
+            realtimeConfig.factorIndex = autoFactorIndex;
+        numPreparedChannels = juce::jlimit(1, MAX_CHANNELS, numCh);
+        sideHoldSamples = juce::roundToInt(SIDE_HOLD_SECONDS * sampleRate);
+        sideActive = true;
+        quietSideSamples = 0;
+
+        // Costruisce le lookup table condivise fuori dall'audio thread
+        WaveshapeTables::getInstance();
         
         initOversamplers(samplesPerBlock);
     }
@@ -66,167 +645,291 @@ public:
         oversampling = shouldOversample;
     }
 
+    // ═══════════════════════════════════════════════════════════
+    // CONFIGURAZIONE OVERSAMPLING
+    // factorIndex: 0..4 → 1x, 2x, 4x, 8x, 16x; in realtime anche
+    //              Parameters::autoOversamplingFactor (dal sample rate)
+    // filterType:  0 = polyphase IIR, 1 = FIR equiripple
+    // La configurazione offline è usata automaticamente quando
+    // l'host renderizza in non-realtime (bounce/export).
+    // ═══════════════════════════════════════════════════════════
+    void setOversamplingFactor(int factorIndex)
+    {
+        autoFactor = factorIndex == Parameters::autoOversamplingFactor;
+        realtimeConfig.factorIndex = autoFactor ? autoFactorIndex : juce::jlimit(0, NUM_OVERSAMPLING_FACTORS - 1, factorIndex);
+    }
+
+    void setOversamplingFilter(int filterType)
+    {
+        realtimeConfig.filterType = juce::jlimit(0, NUM_OVERSAMPLING_FILTERS - 1, filterType);
+    }
+
+    void setOfflineOversamplingFactor(int factorIndex)
+    {
+        offlineConfig.factorIndex = juce::jlimit(0, NUM_OVERSAMPLING_FACTORS - 1, factorIndex);
+    }
+
+    void setOfflineOversamplingFilter(int filterType)
+    {
+        offlineConfig.filterType = juce::jlimit(0, NUM_OVERSAMPLING_FILTERS - 1, filterType);
+    }
+
+    void setNonRealtime(bool shouldUseOfflineConfig)
+    {
+        nonRealtime = shouldUseOfflineConfig;
+    }
+
+    // Modalità Multithread: shaping per canale e DC blocker sul pool
+    // (gli oversampler restano sull'audio thread)
+    void setWorkerPool(WorkerPool* pool) noexcept
+    {
+        workerPool = pool;
+    }
+
+    // Latenza massima tra tutte le configurazioni (per dimensionare il dry delay)
+    int getMaxLatencySamples() const noexcept
+    {
+        int maxLatency = 0;
+        for (int filterType = 0; filterType < NUM_OVERSAMPLING_FILTERS; ++filterType)
+            for (int factorIndex = 0; factorIndex < NUM_OVERSAMPLING_FACTORS; ++factorIndex)
+                maxLatency = juce::jmax(maxLatency, getLatencySamples({ factorIndex, filterType }, 2));
+
+        return maxLatency;
+    }
+
+    // 0 = off, 1 = ADAA 1° ordine, 2 = ADAA 2° ordine
+    void setAntiAliasing(int order)
+    {
+        antiAliasingOrder = juce::jlimit(0, 2, order);
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // CAMBIO DI CONFIGURAZIONE (confine di blocco, audio thread)
+    // Gli oversampler sono tutti preallocati: passare a un'altra
+    // configurazione è un crossfade di CROSSFADE_SAMPLES tra il
+    // percorso vecchio e quello nuovo, senza allocazioni né click.
+    // Un nuovo cambio aspetta la fine del crossfade in corso.
+    // Va chiamato prima di getLatencySamples, così latenza riportata
+    // e percorso in uso cambiano nello stesso blocco.
+    // ═══════════════════════════════════════════════════════════
+    void updateConfiguration()
+    {
+        // Cambio modalità ADAA: lo stato precedente non è più coerente
+        if (antiAliasingOrder != activeAntiAliasingOrder)
+        {
+            for (auto& shaper : adaaShapers)
+                shaper.reset();
+            activeAntiAliasingOrder = antiAliasingOrder;
+            updateAlignment();
+        }
+
+        if (configFade.isActive())
+            return;
+
+        const auto config = getActiveConfig();
+        if (!(config == lastConfig))
+        {
+            // L'oversampler entrante ha ancora lo stato di quando era attivo
+            getOversampler(config)->reset();
+            fadeFromConfig = lastConfig;
+            lastConfig = config;
+            configFade.start();
+            updateAlignment();
+        }
+    }
+
     void setDrive(double value) { drive.setTargetValue(value); }
     void setStereoWidth(float width) { stereoWidth.setTargetValue(width); }
 
+    /**
+     * Modalità mid/side dello shaping: la mid riceve il bias della width,
+     * la side è modellata senza bias e saltata quando è sotto soglia.
+     * Lo stato ADAA è per canale del dominio corrente: riparte pulito, come
+     * al cambio di ordine ADAA.
+     */
+    void setMidSide(bool shouldUseMidSide) noexcept
+    {
+        if (shouldUseMidSide == midSide)
+            return;
+
+        midSide = shouldUseMidSide;
+        sideActive = true;
+        quietSideSamples = 0;
+        for (auto& shaper : adaaShapers)
+            shaper.reset();
+    }
+
+    // Width nulla e ferma: nessun bias tra i canali, L e R restano identici
+    bool hasZeroStereoWidth() const noexcept
+    {
+        return !stereoWidth.isSmoothing() && stereoWidth.getTargetValue() == 0.0;
+    }
+
+    /**
+     * Percorso mono su canali identici: lo shaping (e il DC blocker)
+     * elaborano solo il canale 0 e lo copiano negli altri. Gli oversampler
+     * filtrano comunque tutti i canali (il loro stato non è copiabile),
+     * così all'uscita dal mono il loro stato è già corretto; ADAA e DC
+     * blocker riprendono dallo stato del canale 0.
+     */
+    void setMonoShaping(bool shouldShapeMono) noexcept
+    {
+        if (monoShaping && !shouldShapeMono)
+        {
+            for (int ch = 1; ch < numPreparedChannels; ++ch)
+            {
+                adaaShapers[ch] = adaaShapers[0];
+                dcBlocker.copyLaneState(0, ch);
+            }
+        }
+
+        monoShaping = shouldShapeMono;
+    }
+
+    /**
+     * Coda a ingresso fermo oltre la latenza: la risposta dei filtri di
+     * oversampling (~una latenza dopo il picco) e il DC blocker, che domina
+     * (highpass a 7.5Hz, Q 0.707: ~0.4s). Con ingresso nullo lo shaper dà
+     * al più una costante (bias), che il DC blocker porta a zero.
+     */
+    int getTailSamples() const noexcept
+    {
+        const double timeConstant = Tail::getTimeConstantSamples(DC_BLOCKER_FREQUENCY, 0.5 * juce::MathConstants<double>::sqrt2,
+                                                                 originalSampleRate);
+        return getLatencySamples() + static_cast<int>(std::ceil(Tail::TIME_CONSTANTS_TO_SILENCE * timeConstant));
+    }
+
+    // Latenza del percorso in uso (durante un crossfade: quello entrante)
     int getLatencySamples() const noexcept
     {
-        if (oversampling && oversamplerHigh)
-            return static_cast<int>(oversamplerHigh->getLatencyInSamples());
-        else if (oversamplerBypass)
-            return static_cast<int>(oversamplerBypass->getLatencyInSamples());
-        return 0;
+        return getLatencySamples(lastConfig, activeAntiAliasingOrder);
     }
 
     // ═══════════════════════════════════════════════════════════
     // PROCESS BLOCK
     // ═══════════════════════════════════════════════════════════
     void processBlock(juce::AudioBuffer<float>& buffer,
-        const juce::AudioBuffer<double>& envelopeBuffer)
+        const juce::AudioBuffer<float>& envelopeBuffer)
     {
-        // SAFETY GUARD: se il blocco supera il max inizializzato, reinizializza
-        // gli oversampler per evitare out-of-bounds nei buffer interni.
-        // Può accadere con host che variano la block size a runtime (es. DAW craccati,
-        // o host che usano buffer diversi da quelli dichiarati in prepareToPlay).
-        if (buffer.getNumSamples() > maxSamplesPerBlock)
-        {
-            maxSamplesPerBlock = buffer.getNumSamples();
-            initOversamplers(maxSamplesPerBlock);
-        }
-
-        auto* activeOversampler = oversampling ? oversamplerHigh.get() : oversamplerBypass.get();
-        const int activeFactor = oversampling ? oversamplingFactorHigh : 1;
+        // I blocchi più grandi di quello dichiarato in prepareToPlay vengono
+        // spezzati da SubSaverAudioProcessor::processBlock: qui non si rialloca
+        // mai (niente initOversamplers sull'audio thread)
+        jassert(buffer.getNumSamples() <= maxSamplesPerBlock);
+        jassert(buffer.getNumChannels() <= numPreparedChannels);
 
         const int numChannels = buffer.getNumChannels();
         const int numSamples = buffer.getNumSamples();
         auto envData = envelopeBuffer.getReadPointer(0);
+        const int adaaOrder = activeAntiAliasingOrder;
 
-        // ═══════════════════════════════════════════════════════
-        // FIX: Determina se il morph è in fase di smoothing
-        // Se stabile → campiona una volta (elimina DC artifacts)
-        // Se in transizione → aggiorna alla frequenza NATIVA (non oversampliata)
-        // ═══════════════════════════════════════════════════════
+        // Lo smoothing di morph, drive e width è srotolato in rampe native
         const bool morphIsSmoothing = morphValue.isSmoothing();
-        const bool driveIsSmoothing = drive.isSmoothing();
-        const bool stereoIsSmoothing = stereoWidth.isSmoothing();
-        double currentMorphValue = morphIsSmoothing ? 0.0f : morphValue.getCurrentValue();
-        double currentDriveValue = driveIsSmoothing ? 0.0f : drive.getCurrentValue();
-        double currentWidth = stereoIsSmoothing ? 0.0f : stereoWidth.getCurrentValue();
+        renderParameterRamps(envData, numSamples);
+        const auto* gainRamp = rampBlock.getChannelPointer(1);
 
-        // ═══════════════════════════════════════════════════════
-        // OVERSAMPLING UP
-        // ═══════════════════════════════════════════════════════
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
-        auto oversampledBlock = activeOversampler->processSamplesUp(context.getInputBlock());
+        if (midSide && !monoShaping && numChannels == 2)
+            updateSideActivity(buffer, gainRamp, numSamples);
 
-        const size_t numOversampledChannels = oversampledBlock.getNumChannels();
-        const size_t numOversampledSamples = oversampledBlock.getNumSamples();
+        juce::dsp::AudioBlock<float> block(buffer);
 
         // ═══════════════════════════════════════════════════════
-        // PROCESSING LOOP (oversampled)
+        // CROSSFADE DI CONFIGURAZIONE: il percorso uscente elabora
+        // una copia dell'ingresso nel buffer preallocato, partendo
+        // dallo stesso stato ADAA del percorso entrante
         // ═══════════════════════════════════════════════════════
-        for (size_t sample = 0; sample < numOversampledSamples; ++sample)
-        {
-            // FIX: Aggiorna morphValue solo ai sample nativi (non oversampliati)
-            // Con oversampling 4x: aggiorna solo ogni 4 sample (0, 4, 8, 12...)
-            if (morphIsSmoothing && (sample % activeFactor == 0))
-                currentMorphValue = morphValue.getNextValue();
-
-            if (driveIsSmoothing && (sample % activeFactor == 0))
-                currentDriveValue = drive.getNextValue();
-
-            if (stereoIsSmoothing && (sample % activeFactor == 0))
-                currentWidth = stereoWidth.getNextValue();
-
-            // Map sample index to native rate envelope
-            size_t nativeIndex = sample / activeFactor;
-            if (nativeIndex >= envelopeBuffer.getNumSamples())
-                nativeIndex = envelopeBuffer.getNumSamples() - 1;
+        const bool fading = configFade.isActive();
+        auto fadeBlock = crossfadeBlock.getSubsetChannelBlock(0, static_cast<size_t>(numChannels))
+                                       .getSubBlock(0, static_cast<size_t>(numSamples));
 
-            float env = envData[nativeIndex] + 1.0f; // envelope modulation (1-2)
-
-            // Stereo bias
-            float biasL = currentWidth * (-0.5f);
-            float biasR = currentWidth * (+0.5f);
+        if (fading)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                savedShapers[ch] = adaaShapers[ch];
 
-            // Process each channel
-            for (size_t ch = 0; ch < numOversampledChannels; ++ch)
-            {
-                auto dataPtr = oversampledBlock.getChannelPointer(ch);
-                float input = dataPtr[sample];
+            fadeBlock.copyFrom(block);
+            processPath(fadeFromConfig, fadeBlock, numSamples, morphIsSmoothing, adaaOrder);
 
-                // 1. Apply drive
-                float driven = input * currentDriveValue;
+            for (int ch = 0; ch < numChannels; ++ch)
+                adaaShapers[ch] = savedShapers[ch];
+        }
 
-                // 2. Add stereo bias
-                driven += (ch == 0) ? biasL : biasR;
+        processPath(lastConfig, block, numSamples, morphIsSmoothing, adaaOrder);
 
-                // 3. Modulate with envelope
-                driven *= env;
+        if (fading)
+        {
+            const float* outgoing[MAX_CHANNELS] = {};
+            for (int ch = 0; ch < numChannels; ++ch)
+                outgoing[ch] = fadeBlock.getChannelPointer(static_cast<size_t>(ch));
 
-                // 4. Apply waveshaping (passa morph come parametro)
-                dataPtr[sample] = applyWaveshaping(driven, currentMorphValue);
-            }
+            configFade.process(buffer.getArrayOfWritePointers(), outgoing, numChannels, numSamples);
         }
 
         // ═══════════════════════════════════════════════════════
-        // OVERSAMPLING DOWN
+        // DC BLOCKER + ALLINEAMENTO ADAA + GAIN COMP (native rate,
+        // un solo passaggio)
         // ═══════════════════════════════════════════════════════
-        activeOversampler->processSamplesDown(context.getOutputBlock());
+        const int numFilteredChannels = monoShaping ? 1 : numChannels;
+        dcBlocker.process(buffer.getArrayOfWritePointers(), numFilteredChannels, numSamples, 0.5f, 0.0f, workerPool); // gain compensation
 
-        // ═══════════════════════════════════════════════════════
-        // DC BLOCKER + GAIN COMP (native rate)
-        // ═══════════════════════════════════════════════════════
-        auto bufferData = buffer.getArrayOfWritePointers();
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            for (int i = 0; i < numSamples; ++i)
-            {
-                bufferData[ch][i] = dcBlocker[ch].processSample(bufferData[ch][i]);
-                bufferData[ch][i] *= 0.5f; // gain compensation
-            }
-        }
+        for (int ch = numFilteredChannels; ch < numChannels; ++ch)
+            buffer.copyFrom(ch, 0, buffer, 0, 0, numSamples);
     }
     // ═══════════════════════════════════════════════════════════
         // WAVESHAPING FUNCTIONS (TYPE-SPECIFIC)
         // ═══════════════════════════════════════════════════════════
-    float applyWaveshaping(float x, float morph)
+    static float applyWaveshaping(float x, float morph)
     {
-        // Calcola tutte e 4 le funzioni
-        float shape0 = chebyshevPoly(x);      // 0.0
-        float shape1 = sineFold(x);           // 1.0
-        float shape2 = triangleWavefolder(x); // 2.0
-        float shape3 = foldback(x);           // 3.0
-
-        // Determina quale coppia di funzioni interpolare
+        // Valuta solo le due funzioni del segmento attivo
         if (morph < 1.0f)
         {
             // Morph tra Chebyshev (0) e SineFold (1)
             float blend = morph;
-            return shape0 * (1.0f - blend) + shape1 * blend;
+            return chebyshevPoly(x) * (1.0f - blend) + sineFold(x) * blend;
         }
         else if (morph < 2.0f)
         {
             // Morph tra SineFold (1) e Triangle (2)
             float blend = morph - 1.0f;
-            return shape1 * (1.0f - blend) + shape2 * blend;
+            return sineFold(x) * (1.0f - blend) + triangleWavefolder(x) * blend;
         }
         else
         {
             // Morph tra Triangle (2) e Foldback (3)
             float blend = morph - 2.0f;
-            return shape2 * (1.0f - blend) + shape3 * blend;
+            return triangleWavefolder(x) * (1.0f - blend) + foldback(x) * blend;
         }
     }
 private:
     
 
 
-    // B: Sine Wavefolder (smooth, musical)
+    // ═══════════════════════════════════════════════════════════
+    // OVERSAMPLER CONFIGURATIONS
+    // ═══════════════════════════════════════════════════════════
+    static constexpr int NUM_OVERSAMPLING_FACTORS = 5;  // 1x, 2x, 4x, 8x, 16x
+    static constexpr int NUM_OVERSAMPLING_FILTERS = 2;  // polyphase IIR, FIR equiripple
+    static constexpr int MAX_OVERSAMPLING_FACTOR = 1 << (NUM_OVERSAMPLING_FACTORS - 1);
+    static constexpr int CROSSFADE_SAMPLES = 512;       // ~10ms @ 48kHz
+    static constexpr double AUTO_TARGET_SAMPLE_RATE = 192000.0;
+
+    struct OversamplingConfig
+    {
+        int factorIndex = 2;    // 4x (Auto a 44.1/48kHz)
+        int filterType = Parameters::defaultOversamplingFilter;
+
+        int getFactor() const noexcept { return 1 << factorIndex; }
+
+        bool operator==(const OversamplingConfig& other) const noexcept
+        {
+            return factorIndex == other.factorIndex && filterType == other.filterType;
+        }
+    };
+
+    // B: Sine Wavefolder (smooth, musical) - lookup table condivisa
+    // (percorso scalare/display; l'audio usa WaveshapeSIMD::sineFoldSIMD)
     static float sineFold(float x)
     {
-        return std::sin(juce::MathConstants<float>::twoPi * x);
+        return WaveshapeTables::getInstance().sineFold(x);
     }
 
     // ═══════════════════════════════════════════════════════════════
@@ -235,26 +938,19 @@ private:
 //   - Se |x| <= threshold: return x (lineare)
 //   - Se |x| > threshold: rifletti il segnale attorno alla soglia
 // 
-// Implementazione: 
-//   foldback(x, thresh) = thresh - |x - thresh| se x > thresh
-//                       = -threshold + |x + threshold| se x < -threshold
-//                       = x altrimenti
+// Le riflessioni ripetute attorno a ±threshold equivalgono a un'onda
+// triangolare di periodo 4 * threshold: forma chiusa O(1), senza branch
+// (il vecchio while richiedeva ~190 iterazioni a ±24).
+//   v = (x + threshold) / (4 * threshold)
+//   foldback(x) = 1 - |4 * frac(v) - 2|      (già compensato in gain)
 // ═══════════════════════════════════════════════════════════════
     static float foldback(float x)
     {
         constexpr float threshold = 0.125f; // Soglia di folding
-        constexpr float gainComp = 1.0f / threshold; 
-
-        // Hard folding (riflessione geometrica)
-        while (x > threshold || x < -threshold)
-        {
-            if (x > threshold)
-                x = threshold - (x - threshold);
-            if (x < -threshold)
-                x = -threshold + (-threshold - x);
-        }
+        constexpr float invPeriod = 1.0f / (4.0f * threshold);
 
-        return x * gainComp;
+        const float v = x * invPeriod + 0.25f;
+        return 1.0f - std::abs(4.0f * (v - std::floor(v)) - 2.0f);
     }
     
     // ═══════════════════════════════════════════════════════════════
@@ -282,55 +978,597 @@ private:
     // ═══════════════════════════════════════════════════════════════
     static float chebyshevPoly(float x)
     {
-        // Soft clipping prima di applicare il polinomio per stabilità
-        x = std::tanh(x);
-        // Chebyshev modificato -T3(x) = 3x - 4x³
-        return 3.0f * x - 4.0f * x * x * x;
+        // Soft clipping tanh + Chebyshev modificato -T3(x) = 3x - 4x³,
+        // precalcolati nella lookup table condivisa (percorso scalare/display;
+        // l'audio usa WaveshapeSIMD::chebyshevPolySIMD)
+        return WaveshapeTables::getInstance().chebyshevPoly(x);
+    }
+
+    // Kernel vettoriali delle forme: vedi WaveshapeSIMD
+    using SIMDFloat = WaveshapeSIMD::SIMDFloat;
+
+    /**
+     * Applica il morph su un buffer allineato, in-place.
+     * I pesi delle 4 forme sono max(0, 1 - |morph - k|): equivalente
+     * all'interpolazione a coppie di applyWaveshaping, ma senza branch.
+     * data e morph devono essere allineati e paddati a multipli di SIMDFloat::size().
+     */
+    static void shapeBlockSIMD(float* data, const float* morph, size_t numSamples)
+    {
+        jassert(SIMDFloat::isSIMDAligned(data) && SIMDFloat::isSIMDAligned(morph));
+
+        const auto one = SIMDFloat::expand(1.0f);
+        const auto zero = SIMDFloat::expand(0.0f);
+
+        for (size_t i = 0; i < numSamples; i += SIMDFloat::size())
+        {
+            auto x = SIMDFloat::fromRawArray(data + i);
+            auto m = SIMDFloat::fromRawArray(morph + i);
+
+            auto w0 = SIMDFloat::max(zero, one - SIMDFloat::abs(m));
+            auto w1 = SIMDFloat::max(zero, one - SIMDFloat::abs(m - 1.0f));
+            auto w2 = SIMDFloat::max(zero, one - SIMDFloat::abs(m - 2.0f));
+            auto w3 = SIMDFloat::max(zero, one - SIMDFloat::abs(m - 3.0f));
+
+            auto y = WaveshapeSIMD::chebyshevPolySIMD(x) * w0
+                   + WaveshapeSIMD::sineFoldSIMD(x) * w1
+                   + WaveshapeSIMD::triangleWavefolderSIMD(x) * w2
+                   + WaveshapeSIMD::foldbackSIMD(x) * w3;
+
+            y.copyToRawArray(data + i);
+        }
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // KERNEL SPECIALIZZATI PER SEGMENTO DI MORPH
+    // Con morph statico servono al massimo due forme (una sola se il
+    // morph è esattamente intero): metà delle funzioni trascendenti.
+    // ═══════════════════════════════════════════════════════════
+    enum class MorphSpanType
+    {
+        SingleShape,     // morph intero e fermo: una sola forma
+        StaticBlend,     // morph fermo: due forme, blend costante
+        SegmentRamp,     // morph in smoothing dentro un solo segmento
+        CrossesSegments  // morph in smoothing attraverso un confine: kernel generico
+    };
+
+    struct MorphSpan
+    {
+        MorphSpanType type = MorphSpanType::CrossesSegments;
+        int segment = 0;     // forma (SingleShape) o primo indice del segmento
+        float blend = 0.0f;  // solo per StaticBlend
+    };
+
+    static MorphSpan getMorphSpan(float morph)
+    {
+        MorphSpan span;
+        span.segment = juce::jlimit(0, 2, static_cast<int>(morph));
+        span.blend = morph - static_cast<float>(span.segment);
+
+        if (span.blend == 0.0f || span.blend == 1.0f)
+        {
+            span.type = MorphSpanType::SingleShape;
+            span.segment += static_cast<int>(span.blend);
+        }
+        else
+        {
+            span.type = MorphSpanType::StaticBlend;
+        }
+        return span;
+    }
+
+    static MorphSpan getMorphSpan(const float* morph, size_t numSamples)
+    {
+        auto range = juce::FloatVectorOperations::findMinAndMax(morph, static_cast<int>(numSamples));
+
+        MorphSpan span;
+        span.segment = juce::jlimit(0, 2, static_cast<int>(range.getStart()));
+        span.type = (range.getEnd() <= static_cast<float>(span.segment + 1))
+            ? MorphSpanType::SegmentRamp
+            : MorphSpanType::CrossesSegments;
+        return span;
+    }
+
+    template <int Shape>
+    static void shapeSingleSIMD(float* data, size_t numSamples)
+    {
+        for (size_t i = 0; i < numSamples; i += SIMDFloat::size())
+            WaveshapeSIMD::shapeSIMD<Shape>(SIMDFloat::fromRawArray(data + i)).copyToRawArray(data + i);
+    }
+
+    template <int Segment>
+    static void shapeSegmentSIMD(float* data, float blend, size_t numSamples)
+    {
+        for (size_t i = 0; i < numSamples; i += SIMDFloat::size())
+        {
+            auto x = SIMDFloat::fromRawArray(data + i);
+            auto a = WaveshapeSIMD::shapeSIMD<Segment>(x);
+            auto y = a + (WaveshapeSIMD::shapeSIMD<Segment + 1>(x) - a) * blend;
+            y.copyToRawArray(data + i);
+        }
+    }
+
+    template <int Segment>
+    static void shapeSegmentSIMD(float* data, const float* morph, size_t numSamples)
+    {
+        for (size_t i = 0; i < numSamples; i += SIMDFloat::size())
+        {
+            auto x = SIMDFloat::fromRawArray(data + i);
+            auto blend = SIMDFloat::fromRawArray(morph + i) - static_cast<float>(Segment);
+            auto a = WaveshapeSIMD::shapeSIMD<Segment>(x);
+            auto y = a + (WaveshapeSIMD::shapeSIMD<Segment + 1>(x) - a) * blend;
+            y.copyToRawArray(data + i);
+        }
+    }
+
+    static void shapeBlock(float* data, const float* morph, size_t numSamples, const MorphSpan& span)
+    {
+        switch (span.type)
+        {
+            case MorphSpanType::SingleShape:
+                switch (span.segment)
+                {
+                    case 0:  shapeSingleSIMD<0>(data, numSamples); break;
+                    case 1:  shapeSingleSIMD<1>(data, numSamples); break;
+                    case 2:  shapeSingleSIMD<2>(data, numSamples); break;
+                    default: shapeSingleSIMD<3>(data, numSamples); break;
+                }
+                break;
+
+            case MorphSpanType::StaticBlend:
+                switch (span.segment)
+                {
+                    case 0:  shapeSegmentSIMD<0>(data, span.blend, numSamples); break;
+                    case 1:  shapeSegmentSIMD<1>(data, span.blend, numSamples); break;
+                    default: shapeSegmentSIMD<2>(data, span.blend, numSamples); break;
+                }
+                break;
+
+            case MorphSpanType::SegmentRamp:
+                switch (span.segment)
+                {
+                    case 0:  shapeSegmentSIMD<0>(data, morph, numSamples); break;
+                    case 1:  shapeSegmentSIMD<1>(data, morph, numSamples); break;
+                    default: shapeSegmentSIMD<2>(data, morph, numSamples); break;
+                }
+                break;
+
+            case MorphSpanType::CrossesSegments:
+            default:
+                shapeBlockSIMD(data, morph, numSamples);
+                break;
+        }
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // RAMPE PER-BLOCCO (native rate → oversampled rate)
+    // ═══════════════════════════════════════════════════════════
+    // Smoothing lineare: se la rampa prosegue oltre il blocco (caso comune)
+    // i valori sono start + step * (i + 1), senza la catena di dipendenze
+    // di getNextValue; se finisce dentro il blocco si avanza per sample
+    template <typename SmoothedType>
+    static void renderRamp(SmoothedType& value, float* destination, int numSamples)
+    {
+        if (value.isSmoothing())
+        {
+            auto ahead = value;
+            const auto start = value.getCurrentValue();
+            const auto end = ahead.skip(numSamples);
+
+            if (ahead.isSmoothing())
+            {
+                const auto step = (end - start) / static_cast<decltype(start)>(numSamples);
+
+                for (int i = 0; i < numSamples; ++i)
+                    destination[i] = static_cast<float>(start + step * static_cast<decltype(start)>(i + 1));
+
+                value = ahead;
+                return;
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = static_cast<float>(value.getNextValue());
+        }
+        else
+        {
+            juce::FloatVectorOperations::fill(destination, static_cast<float>(value.getCurrentValue()), numSamples);
+        }
+    }
+
+    // Sample-and-hold di ogni valore nativo per Factor campioni
+    template <int Factor>
+    static void expandRamp(float* destination, const float* nativeRamp, int numNativeSamples)
+    {
+        if constexpr (Factor == 1)
+        {
+            juce::FloatVectorOperations::copy(destination, nativeRamp, numNativeSamples);
+        }
+        else
+        {
+            for (int i = 0; i < numNativeSamples; ++i)
+            {
+                const float value = nativeRamp[i];
+                for (int j = 0; j < Factor; ++j)
+                    destination[i * Factor + j] = value;
+            }
+        }
+    }
+
+    // destination = x * gain + sign * bias, con gain/bias costanti per ogni campione nativo
+    template <int Factor>
+    static void applyDriveRamp(float* destination, const float* source, const float* gainRamp,
+                               const float* biasRamp, float sign, int numNativeSamples)
+    {
+        if constexpr (Factor == 1)
+        {
+            juce::FloatVectorOperations::multiply(destination, source, gainRamp, numNativeSamples);
+            juce::FloatVectorOperations::addWithMultiply(destination, biasRamp, sign, numNativeSamples);
+        }
+        else
+        {
+            for (int i = 0; i < numNativeSamples; ++i)
+            {
+                const float gain = gainRamp[i];
+                const float bias = biasRamp[i] * sign;
+                for (int j = 0; j < Factor; ++j)
+                    destination[i * Factor + j] = source[i * Factor + j] * gain + bias;
+            }
+        }
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // RAMPE DEI PARAMETRI (native rate, una volta per blocco)
+    // Lo smoothing di morph, drive e width viene srotolato qui in buffer
+    // contigui; drive, envelope e bias vengono fusi in due rampe:
+    //   (x * drive + bias) * env = x * (drive * env) + bias * env
+    // Se il morph è stabile il segmento viene scelto una volta sola
+    // (niente DC artifacts), se è in transizione avanza a frequenza NATIVA
+    // ═══════════════════════════════════════════════════════════
+    void renderParameterRamps(const float* envData, int numSamples)
+    {
+        auto* morphRamp = rampBlock.getChannelPointer(0);
+        auto* gainRamp = rampBlock.getChannelPointer(1);
+        auto* biasRamp = rampBlock.getChannelPointer(2);
+        auto* envRamp = rampBlock.getChannelPointer(3);
+
+        renderRamp(morphValue, morphRamp, numSamples);
+        renderRamp(drive, gainRamp, numSamples);
+        renderRamp(stereoWidth, biasRamp, numSamples);
+
+        // envelope modulation (1-2)
+        juce::FloatVectorOperations::add(envRamp, envData, 1.0f, numSamples);
+        juce::FloatVectorOperations::multiply(gainRamp, envRamp, numSamples);
+        juce::FloatVectorOperations::multiply(biasRamp, envRamp, numSamples);
+        juce::FloatVectorOperations::multiply(biasRamp, 0.5f, numSamples); // stereo bias (pari: -, dispari: +)
+    }
+
+    // ═══════════════════════════════════════════════════════════
+    // PERCORSO COMPLETO di una configurazione: up, shaping, down
+    // ═══════════════════════════════════════════════════════════
+    void processPath(const OversamplingConfig& config, juce::dsp::AudioBlock<float>& block, int numSamples,
+                     bool morphIsSmoothing, int adaaOrder)
+    {
+        auto* oversampler = getOversampler(config);
+
+        // OVERSAMPLING UP (il blocco sovracampionato ha i canali
+        // dell'oversampler: solo quelli presenti in ingresso sono validi)
+        auto oversampledBlock = oversampler->processSamplesUp(block)
+                                    .getSubsetChannelBlock(0, block.getNumChannels());
+
+        // PROCESSING (oversampled): un'istanza per fattore, così
+        // l'indice nativo è uno shift e i loop interni si srotolano
+        switch (config.getFactor())
+        {
+            case 1:  shapeOversampled<1>(oversampledBlock, numSamples, morphIsSmoothing, adaaOrder); break;
+            case 2:  shapeOversampled<2>(oversampledBlock, numSamples, morphIsSmoothing, adaaOrder); break;
+            case 4:  shapeOversampled<4>(oversampledBlock, numSamples, morphIsSmoothing, adaaOrder); break;
+            case 8:  shapeOversampled<8>(oversampledBlock, numSamples, morphIsSmoothing, adaaOrder); break;
+            default: shapeOversampled<16>(oversampledBlock, numSamples, morphIsSmoothing, adaaOrder); break;
+        }
+
+        // OVERSAMPLING DOWN
+        oversampler->processSamplesDown(block);
+    }
+
+    template <int Factor>
+    void shapeOversampled(juce::dsp::AudioBlock<float>& oversampledBlock, int numSamples,
+                          bool morphIsSmoothing, int adaaOrder)
+    {
+        static_assert(juce::isPowerOfTwo(Factor), "Oversampling factor must be a power of two");
+
+        const size_t numOversampledSamples = static_cast<size_t>(numSamples) * Factor;
+        jassert(oversampledBlock.getNumSamples() == numOversampledSamples);
+
+        const auto* morphRamp = rampBlock.getChannelPointer(0);
+        const auto* gainRamp = rampBlock.getChannelPointer(1);
+        const auto* biasRamp = rampBlock.getChannelPointer(2);
+        auto* morphData = morphBlock.getChannelPointer(0);
+
+        // Il morph per-sample serve solo in transizione o all'ADAA
+        if (morphIsSmoothing || adaaOrder > 0)
+            expandRamp<Factor>(morphData, morphRamp, numSamples);
+
+        // Dispatch del segmento di morph (una volta per blocco)
+        const auto morphSpan = morphIsSmoothing
+            ? getMorphSpan(morphData, numOversampledSamples)
+            : getMorphSpan(morphRamp[0]);
+
+        const size_t numChannels = oversampledBlock.getNumChannels();
+        const int numData = static_cast<int>(numOversampledSamples);
+
+        // Mid/side: encode dopo l'upsampling, così gli oversampler restano
+        // in L/R e cambiare modalità non tocca lo stato dei loro filtri
+        const bool encodeMidSide = midSide && !monoShaping && numChannels == 2;
+        if (encodeMidSide)
+            MidSide::encode(oversampledBlock.getChannelPointer(0), oversampledBlock.getChannelPointer(1), numData);
+
+        const bool skipSide = encodeMidSide && !sideActive;
+        const bool midSideBias = encodeMidSide || (monoShaping && midSide);
+        const size_t numShapedChannels = (monoShaping || skipSide) ? 1 : numChannels;
+
+        // Canali indipendenti (stato ADAA per canale, rampe in sola lettura):
+        // sul pool ogni task ha il suo buffer di shaping, in serie basta il primo
+        const bool parallel = workerPool != nullptr && numShapedChannels > 1;
+
+        auto shapeChannel = [&](int channel)
+        {
+            const auto ch = static_cast<size_t>(channel);
+            auto* dataPtr = oversampledBlock.getChannelPointer(ch);
+            auto* shaped = shapingBlock.getChannelPointer(parallel ? ch : 0);
+
+            // 1-3. Drive, stereo bias e envelope nel buffer allineato.
+            //      L/R: bias opposto sui canali di ogni coppia (width; nei
+            //      layout multicanale le coppie L/R, Ls/Rs... sono adiacenti);
+            //      M/S: bias solo sulla mid (armoniche pari al centro, side
+            //      simmetrica). Il percorso mono in M/S elabora la sola mid;
+            //      fuori dallo stereo il mid/side non si applica
+            const float biasSign = midSideBias ? (ch == 0 ? 1.0f : 0.0f) : (ch % 2 == 0 ? -1.0f : 1.0f);
+            applyDriveRamp<Factor>(shaped, dataPtr, gainRamp, biasRamp, biasSign, numSamples);
+
+            // 4. Waveshaping: ADAA (1° ordine SIMD, 2° ordine scalare double)
+            //    oppure kernel vettoriale (solo le forme del segmento attivo)
+            if (adaaOrder > 0)
+                adaaShapers[ch].process(shaped, morphData, adaaScratchBlock.getChannelPointer(parallel ? ch : 0),
+                                        numOversampledSamples, adaaOrder);
+            else
+                shapeBlock(shaped, morphData, numOversampledSamples, morphSpan);
+
+            juce::FloatVectorOperations::copy(dataPtr, shaped, static_cast<int>(numOversampledSamples));
+        };
+
+        if (parallel)
+            workerPool->parallelFor(static_cast<int>(numShapedChannels), shapeChannel);
+        else
+            for (int ch = 0; ch < static_cast<int>(numShapedChannels); ++ch)
+                shapeChannel(ch);
+
+        if (encodeMidSide)
+        {
+            // Side sotto soglia: nessuno shaping, contributo nullo
+            if (skipSide)
+                juce::FloatVectorOperations::clear(oversampledBlock.getChannelPointer(1), numData);
+
+            MidSide::decode(oversampledBlock.getChannelPointer(0), oversampledBlock.getChannelPointer(1), numData);
+            return;
+        }
+
+        // Percorso mono: i canali restanti ricevono il canale 0 già elaborato
+        for (size_t ch = numShapedChannels; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::copy(oversampledBlock.getChannelPointer(ch), oversampledBlock.getChannelPointer(0), numData);
+    }
+
+    /**
+     * Side attiva se |S| * drive (ingresso reale dello shaper) supera la
+     * soglia in questo blocco o nell'ultimo hold: evita di accendere e
+     * spegnere lo shaping della side a ogni blocco. Riattivandosi, la side
+     * riparte da uno stato ADAA pulito (il suo ingresso era ~0).
+     */
+    void updateSideActivity(const juce::AudioBuffer<float>& buffer, const float* gainRamp, int numSamples) noexcept
+    {
+        const float* left = buffer.getReadPointer(0);
+        const float* right = buffer.getReadPointer(1);
+
+        float sideLevel = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float level = std::abs(0.5f * (left[i] - right[i]) * gainRamp[i]);
+            sideLevel = level > sideLevel ? level : sideLevel;
+        }
+
+        if (sideLevel > SIDE_THRESHOLD)
+        {
+            if (!sideActive)
+                adaaShapers[1].reset();
+
+            sideActive = true;
+            quietSideSamples = 0;
+            return;
+        }
+
+        quietSideSamples = juce::jmin(quietSideSamples + numSamples, sideHoldSamples);
+        sideActive = quietSideSamples < sideHoldSamples;
+    }
+
+    // Auto: frequenza interna verso AUTO_TARGET_SAMPLE_RATE, come prima dei
+    // parametri di oversampling (4x a 44.1/48kHz, 2x a 88.2/96kHz, 1x a 192kHz)
+    static int getAutoFactorIndex(double sampleRate) noexcept
+    {
+        const int factor = juce::jlimit(1, MAX_OVERSAMPLING_FACTOR, static_cast<int>(AUTO_TARGET_SAMPLE_RATE / sampleRate));
+
+        int factorIndex = 0;
+        while ((2 << factorIndex) <= factor)
+            ++factorIndex;
+
+        return factorIndex;
+    }
+
+    OversamplingConfig getActiveConfig() const noexcept
+    {
+        if (!oversampling)
+            return { 0, 0 };
+
+        return nonRealtime ? offlineConfig : realtimeConfig;
+    }
+
+    // Ritardo ADAA alla frequenza nativa: 0.5 / factor o 1 / factor sample
+    static double getAntiAliasingDelay(const OversamplingConfig& config, int adaaOrder) noexcept
+    {
+        return ADAAShaper::getDelaySamples(adaaOrder) / config.getFactor();
+    }
+
+    /**
+     * Latenza a frequenza nativa di una configurazione: oversampler (intera,
+     * gli oversampler sono creati con useIntegerLatency) più il ritardo ADAA
+     * arrotondato per eccesso. Il resto frazionario è aggiunto al wet dalla
+     * sezione di allineamento (updateAlignment), così la latenza riportata
+     * è esatta.
+     */
+    int getLatencySamples(const OversamplingConfig& config, int adaaOrder) const noexcept
+    {
+        const int adaaLatency = static_cast<int>(std::ceil(getAntiAliasingDelay(config, adaaOrder)));
+
+        if (auto* os = getOversampler(config))
+            return juce::roundToInt(os->getLatencyInSamples()) + adaaLatency;
+        return adaaLatency;
+    }
+
+    /**
+     * Sezione 1 del DC blocker: ritardo frazionario che porta il ritardo
+     * ADAA al sample intero riportato. Allpass di Thiran del primo ordine
+     * sul resto r, a = (1 - r) / (1 + r): ritardo r alle basse frequenze,
+     * ampiezza piatta. Senza resto la sezione è passthrough.
+     */
+    void updateAlignment() noexcept
+    {
+        const double adaaDelay = getAntiAliasingDelay(lastConfig, activeAntiAliasingOrder);
+        const double remainder = std::ceil(adaaDelay) - adaaDelay;
+        auto& section = dcBlocker.getSection(1);
+
+        if (remainder > 0.0)
+        {
+            const auto a = static_cast<float>((1.0 - remainder) / (1.0 + remainder));
+            section = { a, 1.0f, 0.0f, a, 0.0f };
+        }
+        else
+        {
+            section = {};
+        }
+    }
+
+    // A 1x il tipo di filtro è irrilevante: un solo oversampler bypass condiviso
+    juce::dsp::Oversampling<float>* getOversampler(const OversamplingConfig& config) const noexcept
+    {
+        const int filterType = (config.factorIndex == 0) ? 0 : config.filterType;
+        return oversamplers[filterType][config.factorIndex].get();
     }
 
     // ═══════════════════════════════════════════════════════════
-    // OVERSAMPLER INITIALIZATION (DUAL INSTANCES)
+    // OVERSAMPLER INITIALIZATION (TUTTE LE CONFIGURAZIONI)
+    // Tutti gli oversampler sono allocati qui, così cambiare fattore o
+    // filtro durante il playback è solo un cambio di puntatore.
     // ═══════════════════════════════════════════════════════════
     void initOversamplers(int samplesPerBlock)
     {
-        // Oversampler bypass (1x, mantiene latenza coerente)
-        oversamplerBypass = std::make_unique<juce::dsp::Oversampling<float>>(
-            2, // stereo
-            0, // 2^0 = 1x (nessun oversampling)
-            juce::dsp::Oversampling<float>::FilterType::filterHalfBandPolyphaseIIR,
-            true,
-            true
-        );
-        oversamplerBypass->initProcessing(static_cast<size_t>(samplesPerBlock));
-
-        // Oversampler high quality (4x+)
-        oversamplingFactorHigh = static_cast<int>(TARGET_SAMPLING_RATE / originalSampleRate);
-        oversamplingFactorHigh = juce::jmin(16, juce::jmax(1, oversamplingFactorHigh));
-
-        oversamplerHigh = std::make_unique<juce::dsp::Oversampling<float>>(
-            2,
-            static_cast<size_t>(std::log2(oversamplingFactorHigh)),
-            juce::dsp::Oversampling<float>::FilterType::filterHalfBandFIREquiripple,
-            true,
-            true
-        );
-        oversamplerHigh->initProcessing(static_cast<size_t>(samplesPerBlock));
+        using Oversampling = juce::dsp::Oversampling<float>;
+
+        for (int filterType = 0; filterType < NUM_OVERSAMPLING_FILTERS; ++filterType)
+        {
+            for (int factorIndex = 0; factorIndex < NUM_OVERSAMPLING_FACTORS; ++factorIndex)
+            {
+                auto& os = oversamplers[filterType][factorIndex];
+
+                // 1x (bypass, mantiene latenza coerente): solo la prima istanza
+                if (factorIndex == 0 && filterType > 0)
+                {
+                    os.reset();
+                    continue;
+                }
+
+                // useIntegerLatency: la parte frazionaria della latenza dei
+                // filtri è completata da un ritardo frazionario interno, così
+                // getLatencyInSamples è un intero esatto
+                os = std::make_unique<Oversampling>(
+                    static_cast<size_t>(numPreparedChannels),
+                    static_cast<size_t>(factorIndex),
+                    filterType == 0 ? Oversampling::FilterType::filterHalfBandPolyphaseIIR
+                                    : Oversampling::FilterType::filterHalfBandFIREquiripple,
+                    true,  // max quality
+                    true   // integer latency
+                );
+                os->initProcessing(static_cast<size_t>(samplesPerBlock));
+            }
+        }
+
+        lastConfig = getActiveConfig();
+        fadeFromConfig = lastConfig;
+        configFade.reset();
+        activeAntiAliasingOrder = antiAliasingOrder;
+        updateAlignment();
+
+        // Buffer di lavoro allineati: rampe native, morph e campioni oversampled
+        const auto maxOversampledSamples = static_cast<size_t>(samplesPerBlock * MAX_OVERSAMPLING_FACTOR);
+        rampBlock = juce::dsp::AudioBlock<float>(rampMemory, 4, static_cast<size_t>(samplesPerBlock));
+        morphBlock = juce::dsp::AudioBlock<float>(morphMemory, 1, maxOversampledSamples);
+        shapingBlock = juce::dsp::AudioBlock<float>(shapingMemory, static_cast<size_t>(numPreparedChannels), maxOversampledSamples);
+        adaaScratchBlock = juce::dsp::AudioBlock<float>(adaaScratchMemory, static_cast<size_t>(numPreparedChannels), maxOversampledSamples);
+        crossfadeBlock = juce::dsp::AudioBlock<float>(crossfadeMemory, static_cast<size_t>(numPreparedChannels),
+                                                      static_cast<size_t>(samplesPerBlock));
+        crossfadeBlock.clear();
+        rampBlock.clear();
+        morphBlock.clear();
+        shapingBlock.clear();
+        adaaScratchBlock.clear();
     }
 
     juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> drive;
     juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> stereoWidth;
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> morphValue;
-    juce::dsp::IIR::Filter<float> dcBlocker[2];
+    static constexpr double DC_BLOCKER_FREQUENCY = 7.5;
+    static constexpr int MAX_CHANNELS = Parameters::maxChannels;
+    BiquadCascade<2> dcBlocker;               // 0: highpass, 1: allineamento ADAA (updateAlignment)
+    ADAAShaper adaaShapers[MAX_CHANNELS];
+    ADAAShaper savedShapers[MAX_CHANNELS];    // Stato ADAA durante il percorso uscente del crossfade
+    int numPreparedChannels = 2;              // Canali degli oversampler e del buffer di crossfade
 
     WaveshapeType currentType;
     bool oversampling;
+    bool nonRealtime = false;
+    bool monoShaping = false;     // Solo il canale 0, copiato negli altri
+    bool midSide = false;         // Shaping in M/S (dominio sovracampionato)
+    bool sideActive = true;       // Side sopra soglia nell'ultimo hold
+    int quietSideSamples = 0;
+    int sideHoldSamples = 0;
+    static constexpr float SIDE_THRESHOLD = 3.1623e-5f;   // -90dB all'ingresso dello shaper
+    static constexpr double SIDE_HOLD_SECONDS = 0.05;
+    OversamplingConfig realtimeConfig;
+    bool autoFactor = Parameters::defaultOversamplingFactor == Parameters::autoOversamplingFactor;
+    int autoFactorIndex = 2;            // Fattore Auto al sample rate preparato
+    OversamplingConfig offlineConfig{ Parameters::defaultOfflineOversamplingFactor, Parameters::defaultOfflineOversamplingFilter };
+    OversamplingConfig lastConfig;      // Configurazione in uso (entrante durante il crossfade)
+    OversamplingConfig fadeFromConfig;  // Configurazione uscente
+    Crossfade configFade { CROSSFADE_SAMPLES };
+    int antiAliasingOrder = 0;
+    int activeAntiAliasingOrder = 0;
 
     double originalSampleRate = 0.0;
     int maxSamplesPerBlock = 0;
-    int oversamplingFactorHigh = 1;
 
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversamplerBypass;
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversamplerHigh;
+    // [filtro][fattore]: [0][0] è l'oversampler bypass 1x
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversamplers[NUM_OVERSAMPLING_FILTERS][NUM_OVERSAMPLING_FACTORS];
+
+    juce::HeapBlock<char> rampMemory;
+    juce::HeapBlock<char> morphMemory;
+    juce::HeapBlock<char> shapingMemory;
+    juce::HeapBlock<char> adaaScratchMemory;
+    juce::HeapBlock<char> crossfadeMemory;
+    juce::dsp::AudioBlock<float> rampBlock;  // native: 0 morph, 1 drive * env, 2 bias * env, 3 env + 1
+    juce::dsp::AudioBlock<float> morphBlock; // morph oversampled (sample-and-hold)
+    juce::dsp::AudioBlock<float> shapingBlock;
+    juce::dsp::AudioBlock<float> adaaScratchBlock; // x[n-1] per l'ADAA di primo ordine (per canale)
+    juce::dsp::AudioBlock<float> crossfadeBlock; // uscita del percorso uscente (native, tutti i canali)
+    WorkerPool* workerPool = nullptr;            // Modalità Multithread (nullptr: tutto in serie)
+
+    friend struct ShaperBenchmarks;   // Benchmarks/Source/ShaperBenchmarks.h
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveshaperCore)
 };
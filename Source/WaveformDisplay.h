@@ -56,6 +56,7 @@ public:
             bounds.getX() + 4.0f, bounds.getRight() - 4.0f);
 
         const int   numPoints = 300;
+        const auto& tables = WaveshapeTables::getInstance();
         const float currentMorph = morph.load();
         const float currentDrive = drive.load();
 
@@ -66,7 +67,7 @@ public:
             {
                 const float t = float(i) / float(numPoints - 1);
                 const float px = bounds.getX() + t * bounds.getWidth();
-                const float py = cy - std::sin(t * juce::MathConstants<float>::twoPi * 1.5f) * amplitude;
+                const float py = cy - tables.sineFold(t * 1.5f) * amplitude;
                 (i == 0) ? refPath.startNewSubPath(px, py) : refPath.lineTo(px, py);
             }
             juce::Path dashed;
@@ -83,11 +84,11 @@ public:
             {
                 const float t = float(i) / float(numPoints - 1);
                 const float px = bounds.getX() + t * bounds.getWidth();
-                const float input = std::sin(t * juce::MathConstants<float>::twoPi * 1.5f);
+                const float input = tables.sineFold(t * 1.5f);
                 const float driven = input * currentDrive;
 
-                // Usa direttamente WaveshaperCore — nessuna duplicazione
-                const float output = waveshaper.applyWaveshaping(driven, currentMorph);
+                // Usa direttamente WaveshaperCore (stesse lookup table del processing)
+                const float output = WaveshaperCore::applyWaveshaping(driven, currentMorph);
 
                 const float py = cy - juce::jlimit(-1.0f, 1.0f, output) * amplitude;
                 (i == 0) ? distPath.startNewSubPath(px, py) : distPath.lineTo(px, py);
@@ -102,7 +103,6 @@ public:
 
 private:
     juce::AudioProcessorValueTreeState& apvts;
-    WaveshaperCore waveshaper;  // costruttore leggero, prepareToPlay() mai chiamato
     std::atomic<float> morph{ Parameters::defaultMorph };
     std::atomic<float> drive{ Parameters::defaultDrive };
 
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * WAVESHAPE TABLES
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Lookup table condivise (una per processo) per le funzioni di trasferimento
+ * con matematica trascendente: sineFold (sin) e chebyshevPoly (tanh).
+ *
+ * CARATTERISTICHE:
+ * - Interpolazione cubica di Hermite con derivate analitiche: errore
+ *   <= h^4 / 384 * max|f''''|, verificato in costruzione (jassert in debug)
+ * - sineFold: tabella periodica su un periodo, valida per ogni input
+ * - chebyshevPoly: tabella su [-32, 32], copre drive * env (fino a ±24)
+ *   più il bias stereo; oltre il range tanh è saturata e il valore è esatto
+ * - Triangle e Foldback restano in forma chiusa (solo floor/abs, nessuna
+ *   funzione trascendente da sostituire)
+ * - logCoshIntegral: integrale di ln(cosh) in double, serve alla seconda
+ *   antiderivata di chebyshevPoly per l'ADAA di secondo ordine
+ *
+ * USO: solo percorso scalare (WaveformDisplay e applyWaveshaping). Il
+ * percorso audio usa i kernel SIMD polinomiali di WaveshaperCore, più veloci
+ * delle tabelle (nessun gather per lane) ed entro 3e-6 dalla funzione
+ * analitica: vedi `SubSaverBenchmarks tables`. logCoshIntegral invece serve
+ * l'ADAA di secondo ordine sull'audio thread.
+ *
+ * Le tabelle sono costruite al primo getInstance(): WaveshaperCore lo chiama
+ * in prepareToPlay per non farlo mai sull'audio thread.
+ */
+class WaveshapeTables
+{
+public:
+    static const WaveshapeTables& getInstance()
+    {
+        static const WaveshapeTables instance;
+        return instance;
+    }
+
+    // sin(2*pi*x)
+    float sineFold(float x) const noexcept
+    {
+        return sineTable.processPeriodic(x);
+    }
+
+    // -T3(tanh(x)) = 3t - 4t³, t = tanh(x)
+    float chebyshevPoly(float x) const noexcept
+    {
+        return chebyshevTable.processClamped(x);
+    }
+
+    // ln(cosh(x)), stabile anche per |x| grandi
+    static double logCosh(double x) noexcept
+    {
+        x = std::abs(x);
+        return x + std::log1p(std::exp(-2.0 * x)) - LN2;
+    }
+
+    // L2(x) = integrale da 0 a x di ln(cosh(s)) ds (funzione dispari)
+    double logCoshIntegral(double x) const noexcept
+    {
+        const double ax = std::abs(x);
+        double result;
+
+        if (ax <= LOG_COSH_INTEGRAL_RANGE)
+        {
+            result = logCoshIntegralTable.processClamped(ax);
+        }
+        else
+        {
+            // Oltre il range ln(cosh(s)) = |s| - ln2 (a meno di e^-64)
+            result = logCoshIntegralTable.processClamped(LOG_COSH_INTEGRAL_RANGE)
+                   + 0.5 * (ax * ax - LOG_COSH_INTEGRAL_RANGE * LOG_COSH_INTEGRAL_RANGE)
+                   - LN2 * (ax - LOG_COSH_INTEGRAL_RANGE);
+        }
+
+        return x < 0.0 ? -result : result;
+    }
+
+    float getMaxSineError() const noexcept { return sineTable.maxError; }
+    float getMaxChebyshevError() const noexcept { return chebyshevTable.maxError; }
+    double getMaxLogCoshIntegralError() const noexcept { return logCoshIntegralTable.maxError; }
+
+private:
+    static constexpr int SINE_POINTS_PER_PERIOD = 512;
+    static constexpr float CHEBYSHEV_RANGE = 32.0f;
+    static constexpr int CHEBYSHEV_POINTS_PER_UNIT = 64;
+    static constexpr double LOG_COSH_INTEGRAL_RANGE = 32.0;
+    static constexpr int LOG_COSH_INTEGRAL_POINTS_PER_UNIT = 64;
+    static constexpr double LN2 = 0.69314718055994530942;   // juce::MathConstants non ha ln2
+
+    /**
+     * Tabella di Hermite cubica su [xMin, xMax] con passo uniforme.
+     * Le derivate sono pre-scalate per il passo (m * h).
+     */
+    template <typename SampleType>
+    struct HermiteTable
+    {
+        template <typename Function, typename Derivative>
+        void build(Function&& function, Derivative&& derivative, double start, double end, int numIntervals)
+        {
+            xMin = start;
+            step = (end - start) / numIntervals;
+            invStep = 1.0 / step;
+            lastIndex = numIntervals;
+
+            values.resize(static_cast<size_t>(numIntervals) + 1);
+            slopes.resize(static_cast<size_t>(numIntervals) + 1);
+
+            for (int i = 0; i <= numIntervals; ++i)
+            {
+                const double x = start + i * step;
+                values[static_cast<size_t>(i)] = static_cast<SampleType>(function(x));
+                slopes[static_cast<size_t>(i)] = static_cast<SampleType>(derivative(x) * step);
+            }
+        }
+
+        SampleType interpolate(int index, SampleType t) const noexcept
+        {
+            const SampleType p0 = values[static_cast<size_t>(index)];
+            const SampleType p1 = values[static_cast<size_t>(index) + 1];
+            const SampleType m0 = slopes[static_cast<size_t>(index)];
+            const SampleType m1 = slopes[static_cast<size_t>(index) + 1];
+
+            // Forma di Horner della base di Hermite
+            const SampleType c1 = m0;
+            const SampleType c2 = SampleType(3) * (p1 - p0) - SampleType(2) * m0 - m1;
+            const SampleType c3 = SampleType(2) * (p0 - p1) + m0 + m1;
+            return p0 + t * (c1 + t * (c2 + t * c3));
+        }
+
+        SampleType processClamped(SampleType x) const noexcept
+        {
+            const double pos = juce::jlimit(0.0, static_cast<double>(lastIndex), (x - xMin) * invStep);
+            const int index = juce::jmin(static_cast<int>(pos), lastIndex - 1);
+            return interpolate(index, static_cast<SampleType>(pos - index));
+        }
+
+        SampleType processPeriodic(SampleType x) const noexcept
+        {
+            // Tabella costruita su [0, 1): riduci la fase al periodo
+            const double phase = x - std::floor(static_cast<double>(x));
+            const double pos = phase * lastIndex;
+            const int index = juce::jmin(static_cast<int>(pos), lastIndex - 1);
+            return interpolate(index, static_cast<SampleType>(pos - index));
+        }
+
+        template <typename Function>
+        void measureError(Function&& function, double start, double end, int numProbes)
+        {
+            maxError = SampleType(0);
+            for (int i = 0; i <= numProbes; ++i)
+            {
+                const auto x = static_cast<SampleType>(start + (end - start) * i / numProbes);
+                const SampleType y = processClamped(x);
+                maxError = juce::jmax(maxError, static_cast<SampleType>(std::abs(y - function(x))));
+            }
+        }
+
+        std::vector<SampleType> values;
+        std::vector<SampleType> slopes;
+        double xMin = 0.0;
+        double step = 1.0;
+        double invStep = 1.0;
+        int lastIndex = 1;
+        SampleType maxError = SampleType(0);
+    };
+
+    WaveshapeTables()
+    {
+        constexpr double twoPi = juce::MathConstants<double>::twoPi;
+
+        // ═══════════════════════════════════════════════════════════
+        // SINE FOLD: sin(2*pi*x), f'''' max = (2*pi)^4
+        // ═══════════════════════════════════════════════════════════
+        sineTable.build([twoPi](double x) { return std::sin(twoPi * x); },
+                        [twoPi](double x) { return twoPi * std::cos(twoPi * x); },
+                        0.0, 1.0, SINE_POINTS_PER_PERIOD);
+        sineTable.measureError([twoPi](float x) { return std::sin(twoPi * x); },
+                               0.0, 1.0, SINE_POINTS_PER_PERIOD * 16);
+
+        // ═══════════════════════════════════════════════════════════
+        // CHEBYSHEV: 3t - 4t³, t = tanh(x)
+        // f'(x) = (3 - 12t²)(1 - t²)
+        // ═══════════════════════════════════════════════════════════
+        auto chebyshev = [](double x)
+        {
+            const double t = std::tanh(x);
+            return 3.0 * t - 4.0 * t * t * t;
+        };
+
+        chebyshevTable.build(chebyshev,
+                             [](double x)
+                             {
+                                 const double t = std::tanh(x);
+                                 return (3.0 - 12.0 * t * t) * (1.0 - t * t);
+                             },
+                             -CHEBYSHEV_RANGE, CHEBYSHEV_RANGE,
+                             static_cast<int>(2.0f * CHEBYSHEV_RANGE) * CHEBYSHEV_POINTS_PER_UNIT);
+        chebyshevTable.measureError(chebyshev, -CHEBYSHEV_RANGE, CHEBYSHEV_RANGE,
+                                    static_cast<int>(2.0f * CHEBYSHEV_RANGE) * CHEBYSHEV_POINTS_PER_UNIT * 16);
+
+        // ═══════════════════════════════════════════════════════════
+        // LOG-COSH INTEGRAL: L2(x) = int_0^x ln(cosh(s)) ds, L2' = ln(cosh)
+        // Valori per integrazione di Gauss-Legendre (5 punti) per intervallo
+        // ═══════════════════════════════════════════════════════════
+        const int numLogCoshIntervals = static_cast<int>(LOG_COSH_INTEGRAL_RANGE) * LOG_COSH_INTEGRAL_POINTS_PER_UNIT;
+        const double logCoshStep = LOG_COSH_INTEGRAL_RANGE / numLogCoshIntervals;
+        std::vector<double> integralValues(static_cast<size_t>(numLogCoshIntervals) + 1, 0.0);
+
+        for (int i = 0; i < numLogCoshIntervals; ++i)
+        {
+            integralValues[static_cast<size_t>(i) + 1] = integralValues[static_cast<size_t>(i)]
+                + gaussLegendre(logCosh, i * logCoshStep, (i + 1) * logCoshStep);
+        }
+
+        logCoshIntegralTable.build([&integralValues, logCoshStep](double x)
+                                   {
+                                       return integralValues[static_cast<size_t>(juce::roundToInt(x / logCoshStep))];
+                                   },
+                                   logCosh, 0.0, LOG_COSH_INTEGRAL_RANGE, numLogCoshIntervals);
+
+        // Errore sui punti medi contro l'integrale esatto dell'intervallo
+        logCoshIntegralTable.maxError = 0.0;
+        for (int i = 0; i < numLogCoshIntervals; ++i)
+        {
+            const double x = (i + 0.5) * logCoshStep;
+            const double exact = integralValues[static_cast<size_t>(i)] + gaussLegendre(logCosh, i * logCoshStep, x);
+            logCoshIntegralTable.maxError = juce::jmax(logCoshIntegralTable.maxError,
+                                                       std::abs(logCoshIntegralTable.processClamped(x) - exact));
+        }
+
+        // Bound garantiti (margine sopra l'errore di quantizzazione float)
+        jassert(sineTable.maxError < 1.0e-6f);
+        jassert(chebyshevTable.maxError < 1.0e-6f);
+        jassert(logCoshIntegralTable.maxError < 1.0e-9);
+    }
+
+    template <typename Function>
+    static double gaussLegendre(Function&& function, double a, double b)
+    {
+        static constexpr double nodes[] = { 0.0, -0.5384693101056831, 0.5384693101056831,
+                                            -0.9061798459386640, 0.9061798459386640 };
+        static constexpr double weights[] = { 0.5688888888888889, 0.4786286704993665, 0.4786286704993665,
+                                              0.2369268850561891, 0.2369268850561891 };
+
+        const double halfWidth = 0.5 * (b - a);
+        const double centre = 0.5 * (a + b);
+        double sum = 0.0;
+
+        for (int i = 0; i < 5; ++i)
+            sum += weights[i] * function(centre + halfWidth * nodes[i]);
+
+        return sum * halfWidth;
+    }
+
+    HermiteTable<float> sineTable;
+    HermiteTable<float> chebyshevTable;
+    HermiteTable<double> logCoshIntegralTable;
+
+    JUCE_DECLARE_NON_COPYABLE(WaveshapeTables)
+};
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+/**
+ * ═══════════════════════════════════════════════════════════════════════════
+ * WORKER POOL
+ * ═══════════════════════════════════════════════════════════════════════════
+ *
+ * Thread che eseguono lavoro per canale (shaping, tilt, disperser) in
+ * parallelo all'audio thread, in modalità Multithread. Avviati solo con la
+ * modalità attiva (prepareToPlay o message thread), mai dall'audio thread.
+ *
+ * CARATTERISTICHE:
+ * - parallelFor(numTasks, task): i task sono indici presi da un contatore
+ *   atomico; l'audio thread partecipa e prende i task rimasti
+ * - Nessuna allocazione sull'audio thread: il job è pubblicato con un solo
+ *   store atomico e l'audio thread aspetta (spin) solo i task già presi da
+ *   un worker. Un worker ancora fermo o in ritardo non trattiene il blocco:
+ *   il suo lavoro lo fa l'audio thread
+ * - Stato del job in una sola parola atomica (generazione, numero di task,
+ *   prossimo indice): un worker in ritardo non può prendere un task di un
+ *   job successivo
+ * - L'audio thread non tocca mai thread, eventi o lock: pubblica il job
+ *   (store di state) e basta. I worker girano su state (spin con pause,
+ *   un yield ogni YIELD_INTERVAL giri)
+ *   finché vedono job entro il tempo di spin (setSpinTime, circa due
+ *   blocchi): ogni job visto riarma lo spin, quindi durante il playback
+ *   restano sempre pronti
+ * - Senza job per più del tempo di spin un worker si parcheggia da solo
+ *   con attese brevi a timeout (PARK_INTERVAL_MS) sul proprio evento, che
+ *   nessuno segnala tranne stopThread: al primo job dopo una pausa
+ *   l'audio thread fa da solo i task, il worker lo vede entro un
+ *   intervallo e torna a girare
+ * - Un job alla volta, pubblicato solo dall'audio thread
+ */
+class WorkerPool
+{
+public:
+    static constexpr int MAX_WORKERS = 8;
+
+    WorkerPool() = default;
+
+    ~WorkerPool()
+    {
+        stop();
+    }
+
+    /**
+     * Avvia numWorkers thread (message thread, mai a processBlock in corso
+     * con questo pool). 0 worker: parallelFor esegue tutto sull'audio thread.
+     */
+    void start(int numWorkers)
+    {
+        stop();
+
+        numWorkers = juce::jlimit(0, MAX_WORKERS, numWorkers);
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            auto* worker = workers.add(new Worker(*this, i));
+            worker->startThread(juce::Thread::Priority::highest);
+        }
+
+        started.store(true, std::memory_order_release);
+    }
+
+    void stop()
+    {
+        started.store(false, std::memory_order_release);
+
+        for (auto* worker : workers)
+            worker->signalThreadShouldExit();
+
+        workers.clear(); // ~Worker (stopThread) sveglia il thread e ne aspetta la fine
+    }
+
+    // Avviato e utilizzabile: l'audio thread lo legge prima di usare il pool
+    bool isStarted() const noexcept
+    {
+        return started.load(std::memory_order_acquire);
+    }
+
+    int getNumWorkers() const noexcept
+    {
+        return workers.size();
+    }
+
+    /**
+     * Quanto un worker resta in spin senza job prima di parcheggiarsi.
+     * Va oltre l'intervallo fra due blocchi, così in playback non si ferma.
+     */
+    void setSpinTime(double seconds) noexcept
+    {
+        spinTicks.store(static_cast<juce::int64>(seconds * static_cast<double>(juce::Time::getHighResolutionTicksPerSecond())),
+                        std::memory_order_relaxed);
+    }
+
+    /**
+     * Esegue task(0) ... task(numTasks - 1), in parallelo se ci sono worker.
+     * Ritorna quando tutti i task sono finiti (audio thread).
+     */
+    template <typename Task>
+    void parallelFor(int numTasks, Task&& task)
+    {
+        jassert(numTasks <= MAX_TASKS);
+
+        if (workers.isEmpty() || numTasks <= 1)
+        {
+            for (int i = 0; i < numTasks; ++i)
+                task(i);
+            return;
+        }
+
+        // Pubblica il job: funzione e contesto prima dello store di release
+        using TaskType = std::remove_reference_t<Task>;
+        job = [](void* context, int index) { (*static_cast<TaskType*>(context))(index); };
+        jobContext = const_cast<void*>(static_cast<const void*>(std::addressof(task)));
+        completedTasks.store(0, std::memory_order_relaxed);
+
+        const auto generation = (state.load(std::memory_order_relaxed) >> GENERATION_SHIFT) + 1;
+        state.store((generation << GENERATION_SHIFT) | (static_cast<juce::uint64>(numTasks) << TOTAL_SHIFT),
+                    std::memory_order_release);
+
+        // Nessun risveglio: i worker in spin vedono la nuova generazione
+        runTasks();
+
+        // Solo i task presi da un worker e ancora in esecuzione
+        while (completedTasks.load(std::memory_order_acquire) < numTasks)
+            pause();
+    }
+
+private:
+    static constexpr int MAX_TASKS = 0xffff;
+    static constexpr int GENERATION_SHIFT = 32;
+    static constexpr int TOTAL_SHIFT = 16;
+    static constexpr int PARK_INTERVAL_MS = 1;
+    static constexpr int YIELD_INTERVAL = 64;
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(WorkerPool& owner, int index)
+            : juce::Thread("SubSaver Worker " + juce::String(index + 1)), pool(owner)
+        {
+        }
+
+        ~Worker() override
+        {
+            stopThread(1000);
+        }
+
+        void run() override
+        {
+            // I task sono DSP per canale: FTZ/DAZ come sull'audio thread
+            juce::ScopedNoDenormals noDenormals;
+
+            auto lastGeneration = pool.getGeneration();
+            auto lastJobTicks = juce::Time::getHighResolutionTicks();
+            int spins = 0;
+
+            while (!threadShouldExit())
+            {
+                // Nuovo job: prende i task rimasti e riarma lo spin
+                const auto generation = pool.getGeneration();
+                if (generation != lastGeneration)
+                {
+                    lastGeneration = generation;
+                    lastJobTicks = juce::Time::getHighResolutionTicks();
+                    pool.runTasks();
+                    continue;
+                }
+
+                // Spin con un yield ogni tanto: con più worker che core libera la CPU
+                if (juce::Time::getHighResolutionTicks() - lastJobTicks < pool.spinTicks.load(std::memory_order_relaxed))
+                {
+                    if (++spins % YIELD_INTERVAL == 0)
+                        yield();
+                    else
+                        pause();
+                }
+                else
+                    wait(PARK_INTERVAL_MS); // Parcheggiato: nessun notify, solo timeout o stopThread
+            }
+        }
+
+    private:
+        WorkerPool& pool;
+
+        JUCE_DECLARE_NON_COPYABLE(Worker)
+    };
+
+    /**
+     * Prende ed esegue task finché ne restano nel job corrente.
+     * Il claim è un CAS sull'intera parola di stato: riesce solo se il job
+     * è ancora quello letto, quindi funzione e contesto sono validi finché
+     * il task non è contato come completato.
+     */
+    void runTasks() noexcept
+    {
+        auto current = state.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            const auto total = static_cast<int>((current >> TOTAL_SHIFT) & MAX_TASKS);
+            const auto next = static_cast<int>(current & MAX_TASKS);
+
+            if (next >= total)
+                return;
+
+            if (!state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_acquire))
+                continue;
+
+            job(jobContext, next);
+            completedTasks.fetch_add(1, std::memory_order_release);
+            current = state.load(std::memory_order_acquire);
+        }
+    }
+
+    juce::uint64 getGeneration() const noexcept
+    {
+        return state.load(std::memory_order_acquire) >> GENERATION_SHIFT;
+    }
+
+    static void pause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #endif
+    }
+
+    // [generazione: 32][numero di task: 16][prossimo indice: 16]
+    std::atomic<juce::uint64> state { 0 };
+    std::atomic<int> completedTasks { 0 };
+    std::atomic<juce::int64> spinTicks { 0 };
+    void (*job)(void*, int) = nullptr;
+    void* jobContext = nullptr;
+
+    juce::OwnedArray<Worker> workers;
+    std::atomic<bool> started { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkerPool)
+};